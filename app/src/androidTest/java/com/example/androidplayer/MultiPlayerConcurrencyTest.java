@@ -0,0 +1,192 @@
+package com.example.androidplayer;
+
+import android.graphics.SurfaceTexture;
+import android.view.Surface;
+
+import androidx.test.ext.junit.runners.AndroidJUnit4;
+
+import org.junit.After;
+import org.junit.Before;
+import org.junit.BeforeClass;
+import org.junit.Test;
+import org.junit.runner.RunWith;
+
+import java.io.File;
+import java.util.ArrayList;
+import java.util.List;
+import java.util.Random;
+import java.util.concurrent.CountDownLatch;
+import java.util.concurrent.TimeUnit;
+import java.util.concurrent.atomic.AtomicInteger;
+import java.util.concurrent.atomic.AtomicReference;
+
+import static org.junit.Assert.*;
+import static org.junit.Assume.assumeTrue;
+
+/**
+ * 多个播放器同时播放，各自暂停、跳转、变速互不影响；并发乱序操作之后每个播放器都还能正常播放，
+ * 释放其中一部分不影响其余的。需要设备上有 /sdcard/testfile.mp4，没有时跳过。
+ */
+@RunWith(AndroidJUnit4.class)
+public class MultiPlayerConcurrencyTest {
+    private static final String TEST_FILE = "/sdcard/testfile.mp4";
+    private static final int PLAYERS = 8;
+    private static final long OBSERVE_MS = 2000;
+    private static final long CHAOS_MS = 5000;
+
+    private final List<SurfaceTexture> textures = new ArrayList<>();
+    private final List<Surface> surfaces = new ArrayList<>();
+    private final List<Player> players = new ArrayList<>();
+
+    @BeforeClass
+    public static void loadLibrary() {
+        System.loadLibrary("androidplayer");
+    }
+
+    @Before
+    public void setUp() throws Exception {
+        assumeTrue("missing " + TEST_FILE, new File(TEST_FILE).canRead());
+        Player.setStandbyCache(0, 0);
+
+        CountDownLatch prepared = new CountDownLatch(PLAYERS);
+        AtomicInteger failures = new AtomicInteger();
+        for (int i = 0; i < PLAYERS; i++) {
+            SurfaceTexture texture = new SurfaceTexture(false);
+            texture.setDefaultBufferSize(320, 180);
+            Surface surface = new Surface(texture);
+            Player player = new Player();
+            player.setDataSource("file:" + TEST_FILE);
+            player.setSurface(surface);
+            player.setOnPreparedListener((p, result) -> {
+                if (result != 0) failures.incrementAndGet();
+                prepared.countDown();
+            });
+            textures.add(texture);
+            surfaces.add(surface);
+            players.add(player);
+        }
+        for (Player player : players) player.prepare();
+        assertTrue("prepare timed out", prepared.await(30, TimeUnit.SECONDS));
+        assertEquals("prepare failed", 0, failures.get());
+        for (Player player : players) player.start();
+    }
+
+    @After
+    public void tearDown() {
+        for (Player player : players) {
+            player.stop();
+            player.release();
+        }
+        for (Surface surface : surfaces) surface.release();
+        for (SurfaceTexture texture : textures) texture.release();
+    }
+
+    @Test
+    public void controlsOnOnePlayerDoNotLeakIntoOthers() throws Exception {
+        Thread.sleep(1000);
+        Player paused = players.get(0);
+        Player fast = players.get(1);
+        Player seeked = players.get(2);
+        Player normal = players.get(3);
+
+        paused.pause(true);
+        fast.setSpeed(2);
+        seeked.seek(0.5);
+        Thread.sleep(500);
+
+        double[] before = progress();
+        Thread.sleep(OBSERVE_MS);
+        double[] after = progress();
+
+        assertEquals("paused player moved", before[0], after[0], 1e-3);
+        assertTrue("seek did not land: " + after[2], after[2] >= 0.45);
+        double normalDelta = after[3] - before[3];
+        double fastDelta = after[1] - before[1];
+        assertTrue("normal player stalled", normalDelta > 0);
+        double ratio = fastDelta / normalDelta;
+        assertTrue("2x player advanced " + ratio + "x as fast", ratio > 1.5 && ratio < 2.5);
+        // 其余播放器不受前面几个的操作影响，和 normal 的速度一致
+        for (int i = 4; i < PLAYERS; i++) {
+            double delta = after[i] - before[i];
+            assertEquals("player " + i + " speed", normalDelta, delta, normalDelta * 0.25);
+        }
+    }
+
+    @Test
+    public void concurrentControlsLeaveEveryPlayerPlayable() throws Exception {
+        AtomicReference<Throwable> error = new AtomicReference<>();
+        List<Thread> threads = new ArrayList<>();
+        long end = System.currentTimeMillis() + CHAOS_MS;
+        for (int i = 0; i < PLAYERS; i++) {
+            Player player = players.get(i);
+            Random random = new Random(i);
+            Thread t = new Thread(() -> {
+                try {
+                    while (System.currentTimeMillis() < end) {
+                        switch (random.nextInt(6)) {
+                            case 0: player.seek(random.nextDouble() * 0.8); break;
+                            case 1: player.pause(random.nextBoolean()); break;
+                            case 2: player.setSpeed(new float[]{0.5f, 1f, 2f, -1f}[random.nextInt(4)]); break;
+                            case 3: player.hintSeek(random.nextDouble()); break;
+                            case 4: player.stepForward(); break;
+                            default: player.getStats(); break;
+                        }
+                        Thread.sleep(random.nextInt(50));
+                    }
+                } catch (Throwable e) {
+                    error.compareAndSet(null, e);
+                }
+            }, "control-" + i);
+            threads.add(t);
+            t.start();
+        }
+        for (Thread t : threads) t.join();
+        assertNull("control thread failed: " + error.get(), error.get());
+
+        // 全部恢复到正放 1x，每个播放器都要继续前进
+        for (Player player : players) {
+            player.setSpeed(1);
+            player.seek(0.1);
+            player.pause(false);
+        }
+        Thread.sleep(1000);
+        double[] before = progress();
+        Thread.sleep(OBSERVE_MS);
+        double[] after = progress();
+        for (int i = 0; i < PLAYERS; i++) {
+            assertEquals("player " + i, Player.PlayerState.Playing, players.get(i).getState());
+            assertTrue("player " + i + " stalled at " + after[i], after[i] > before[i]);
+        }
+    }
+
+    @Test
+    public void releasingSomePlayersKeepsTheRestPlaying() throws Exception {
+        Thread.sleep(1000);
+        // 释放偶数号播放器，奇数号继续播放
+        List<Player> kept = new ArrayList<>();
+        for (int i = 0; i < PLAYERS; i++) {
+            Player player = players.get(i);
+            if (i % 2 == 0) {
+                player.stop();
+                player.release();
+            } else {
+                kept.add(player);
+            }
+        }
+        players.clear();
+        players.addAll(kept);
+
+        double[] before = progress();
+        Thread.sleep(OBSERVE_MS);
+        double[] after = progress();
+        for (int i = 0; i < players.size(); i++) {
+            assertTrue("player " + i + " stalled at " + after[i], after[i] > before[i]);
+        }
+    }
+
+    private double[] progress() {
+        double[] p = new double[players.size()];
+        for (int i = 0; i < p.length; i++) p[i] = players.get(i).getProgress();
+        return p;
+    }
+}
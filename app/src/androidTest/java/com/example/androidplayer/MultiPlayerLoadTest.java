@@ -0,0 +1,175 @@
+package com.example.androidplayer;
+
+import android.graphics.SurfaceTexture;
+import android.system.Os;
+import android.system.OsConstants;
+import android.util.Log;
+import android.view.Surface;
+
+import androidx.test.ext.junit.runners.AndroidJUnit4;
+
+import org.junit.Before;
+import org.junit.BeforeClass;
+import org.junit.Test;
+import org.junit.runner.RunWith;
+
+import java.io.File;
+import java.nio.charset.StandardCharsets;
+import java.nio.file.Files;
+import java.nio.file.Paths;
+import java.util.ArrayList;
+import java.util.List;
+import java.util.concurrent.CountDownLatch;
+import java.util.concurrent.TimeUnit;
+import java.util.concurrent.atomic.AtomicInteger;
+import java.util.regex.Matcher;
+import java.util.regex.Pattern;
+
+import static org.junit.Assert.*;
+import static org.junit.Assume.assumeTrue;
+
+/**
+ * 同时播放 1/4/16 个播放器，测量进程 CPU、线程数和丢帧，结果打到 logcat（tag PlayerLoadTest）。
+ * 每多一个播放器增加的线程数不能随核数增长：转换条带跑在共享调度器上，不再有每个播放器自己的线程池。
+ * 需要设备上有 /sdcard/testfile.mp4，没有时跳过。
+ */
+@RunWith(AndroidJUnit4.class)
+public class MultiPlayerLoadTest {
+    private static final String TAG = "PlayerLoadTest";
+    private static final String TEST_FILE = "/sdcard/testfile.mp4";
+    private static final int[] PLAYER_COUNTS = {1, 4, 16};
+    private static final long MEASURE_MS = 10000;
+    // 每个播放器自己的线程：解码、渲染、prepare、AAudio 回调，加上解码器内部的线程
+    private static final int DEDICATED_THREADS = 4;
+
+    private static final Pattern DECODE_THREADS = Pattern.compile("decode threads: \\w+ x(\\d+)");
+    private static final Pattern FPS = Pattern.compile(
+            "fps: decoded ([\\d.]+), converted [\\d.]+, presented ([\\d.]+) \\((\\d+) decimated, (\\d+) late\\)");
+
+    private static class Result {
+        int players;
+        double cpuPercent;   // 一个核的百分比
+        int threads;
+        int codecThreads;    // 单个解码器的线程数（取最大）
+        double decodedFps;   // 所有播放器合计
+        double presentedFps;
+        long late;
+    }
+
+    @BeforeClass
+    public static void loadLibrary() {
+        System.loadLibrary("androidplayer");
+    }
+
+    @Before
+    public void setUp() {
+        assumeTrue("missing " + TEST_FILE, new File(TEST_FILE).canRead());
+        Player.setStandbyCache(0, 0);
+    }
+
+    @Test
+    public void cpuAndDropsScaleWithPlayerCount() throws Exception {
+        int baseline = countThreads();
+        List<Result> results = new ArrayList<>();
+        for (int players : PLAYER_COUNTS) {
+            results.add(measure(players));
+        }
+
+        Log.i(TAG, String.format("baseline threads %d", baseline));
+        for (Result r : results) {
+            Log.i(TAG, String.format("%2d players: cpu %.1f%% (%.1f%% per player), threads %d, "
+                            + "decoded %.1f fps, presented %.1f fps, %d late",
+                    r.players, r.cpuPercent, r.cpuPercent / r.players, r.threads,
+                    r.decodedFps, r.presentedFps, r.late));
+            assertTrue(r.players + " players presented nothing", r.presentedFps > 0);
+        }
+
+        // 单个播放器不应该因为过载丢帧
+        Result single = results.get(0);
+        assertTrue("1 player dropped " + single.late + " late frames",
+                single.late <= Math.max(2, (long) (single.decodedFps * MEASURE_MS / 1000 * 0.02)));
+
+        // 从 1 个到 16 个播放器，每个播放器增加的线程只有它自己的那几个
+        Result most = results.get(results.size() - 1);
+        double perPlayer = (most.threads - single.threads) / (double) (most.players - single.players);
+        int budget = DEDICATED_THREADS + most.codecThreads;
+        assertTrue(String.format("%.1f threads per extra player, budget %d", perPlayer, budget),
+                perPlayer <= budget);
+    }
+
+    private Result measure(int count) throws Exception {
+        List<SurfaceTexture> textures = new ArrayList<>();
+        List<Surface> surfaces = new ArrayList<>();
+        List<Player> players = new ArrayList<>();
+        CountDownLatch prepared = new CountDownLatch(count);
+        AtomicInteger failures = new AtomicInteger();
+
+        for (int i = 0; i < count; i++) {
+            SurfaceTexture texture = new SurfaceTexture(false);
+            texture.setDefaultBufferSize(320, 180);
+            Surface surface = new Surface(texture);
+            Player player = new Player();
+            player.setDataSource("file:" + TEST_FILE);
+            player.setSurface(surface);
+            player.setOnPreparedListener((p, result) -> {
+                if (result != 0) failures.incrementAndGet();
+                prepared.countDown();
+            });
+            textures.add(texture);
+            surfaces.add(surface);
+            players.add(player);
+        }
+
+        Result r = new Result();
+        r.players = count;
+        try {
+            for (Player player : players) player.prepare();
+            assertTrue("prepare timed out", prepared.await(30, TimeUnit.SECONDS));
+            assertEquals("prepare failed", 0, failures.get());
+
+            for (Player player : players) player.start();
+            // 跳过启动阶段再开始计量
+            Thread.sleep(1000);
+            long cpuStart = processCpuMs();
+            long wallStart = System.nanoTime();
+            Thread.sleep(MEASURE_MS);
+            long cpu = processCpuMs() - cpuStart;
+            long wall = (System.nanoTime() - wallStart) / 1000000;
+
+            r.cpuPercent = cpu * 100.0 / wall;
+            r.threads = countThreads();
+            for (Player player : players) {
+                String stats = player.getStats();
+                Matcher threads = DECODE_THREADS.matcher(stats);
+                if (threads.find()) r.codecThreads = Math.max(r.codecThreads, Integer.parseInt(threads.group(1)));
+                Matcher fps = FPS.matcher(stats);
+                assertTrue("unexpected stats: " + stats, fps.find());
+                r.decodedFps += Double.parseDouble(fps.group(1));
+                r.presentedFps += Double.parseDouble(fps.group(2));
+                r.late += Long.parseLong(fps.group(4));
+            }
+        } finally {
+            for (Player player : players) {
+                player.stop();
+                player.release();
+            }
+            for (Surface surface : surfaces) surface.release();
+            for (SurfaceTexture texture : textures) texture.release();
+        }
+        return r;
+    }
+
+    // 进程累计的用户态加内核态 CPU 时间（毫秒），/proc/self/stat 的第 14、15 项
+    private static long processCpuMs() throws Exception {
+        String stat = new String(Files.readAllBytes(Paths.get("/proc/self/stat")), StandardCharsets.US_ASCII);
+        // 进程名可能含空格，从最后一个右括号之后开始数，第 3 项是 state
+        String[] fields = stat.substring(stat.lastIndexOf(')') + 2).split(" ");
+        long ticks = Long.parseLong(fields[11]) + Long.parseLong(fields[12]);
+        return ticks * 1000 / Os.sysconf(OsConstants._SC_CLK_TCK);
+    }
+
+    private static int countThreads() {
+        String[] names = new File("/proc/self/task").list();
+        return names == null ? 0 : names.length;
+    }
+}
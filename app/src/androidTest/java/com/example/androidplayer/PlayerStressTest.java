@@ -0,0 +1,137 @@
+package com.example.androidplayer;
+
+import android.graphics.SurfaceTexture;
+import android.view.Surface;
+
+import androidx.test.ext.junit.runners.AndroidJUnit4;
+
+import org.junit.After;
+import org.junit.Before;
+import org.junit.BeforeClass;
+import org.junit.Test;
+import org.junit.runner.RunWith;
+
+import java.io.File;
+import java.util.concurrent.CountDownLatch;
+import java.util.concurrent.TimeUnit;
+import java.util.concurrent.atomic.AtomicInteger;
+
+import static org.junit.Assert.*;
+import static org.junit.Assume.assumeTrue;
+
+/**
+ * 反复 prepare/start/stop，检查停止后线程和文件描述符都回到起点。
+ * 需要设备上有 /sdcard/testfile.mp4，没有时跳过。
+ */
+@RunWith(AndroidJUnit4.class)
+public class PlayerStressTest {
+    private static final String TEST_FILE = "/sdcard/testfile.mp4";
+    private static final int CYCLES = 10000;
+    // 系统线程（binder、GC、AAudio 回调）会自己增减，允许少量波动
+    private static final int THREAD_SLACK = 4;
+    private static final int FD_SLACK = 4;
+
+    private SurfaceTexture texture;
+    private Surface surface;
+
+    @BeforeClass
+    public static void loadLibrary() {
+        System.loadLibrary("androidplayer");
+    }
+
+    @Before
+    public void setUp() {
+        assumeTrue("missing " + TEST_FILE, new File(TEST_FILE).canRead());
+        // 关闭热备：stop 之后不应该留下任何打开的输入
+        Player.setStandbyCache(0, 0);
+        texture = new SurfaceTexture(false);
+        texture.setDefaultBufferSize(640, 360);
+        surface = new Surface(texture);
+    }
+
+    @After
+    public void tearDown() {
+        if (surface != null) surface.release();
+        if (texture != null) texture.release();
+    }
+
+    @Test
+    public void startStopDoesNotLeakThreadsOrFds() throws Exception {
+        Player player = newPlayer();
+        // 第一轮创建调度器、音频设备等进程级的线程，之后才取基线
+        cycle(player);
+        int threads = waitForCount("/proc/self/task", Integer.MAX_VALUE);
+        int fds = waitForCount("/proc/self/fd", Integer.MAX_VALUE);
+
+        for (int i = 0; i < CYCLES; i++) {
+            cycle(player);
+        }
+        player.release();
+
+        int threadsAfter = waitForCount("/proc/self/task", threads + THREAD_SLACK);
+        int fdsAfter = waitForCount("/proc/self/fd", fds + FD_SLACK);
+        assertTrue("threads " + threads + " -> " + threadsAfter, threadsAfter <= threads + THREAD_SLACK);
+        assertTrue("fds " + fds + " -> " + fdsAfter, fdsAfter <= fds + FD_SLACK);
+    }
+
+    @Test
+    public void releaseAfterEachCycleDoesNotLeak() throws Exception {
+        Player warmup = newPlayer();
+        cycle(warmup);
+        warmup.release();
+        int threads = waitForCount("/proc/self/task", Integer.MAX_VALUE);
+        int fds = waitForCount("/proc/self/fd", Integer.MAX_VALUE);
+
+        // 每轮新建和释放 native 上下文
+        for (int i = 0; i < CYCLES / 10; i++) {
+            Player player = newPlayer();
+            cycle(player);
+            player.release();
+        }
+
+        int threadsAfter = waitForCount("/proc/self/task", threads + THREAD_SLACK);
+        int fdsAfter = waitForCount("/proc/self/fd", fds + FD_SLACK);
+        assertTrue("threads " + threads + " -> " + threadsAfter, threadsAfter <= threads + THREAD_SLACK);
+        assertTrue("fds " + fds + " -> " + fdsAfter, fdsAfter <= fds + FD_SLACK);
+    }
+
+    private Player newPlayer() {
+        Player player = new Player();
+        player.setDataSource("file:" + TEST_FILE);
+        player.setSurface(surface);
+        return player;
+    }
+
+    // prepare 完成后 start，马上 stop
+    private void cycle(Player player) throws InterruptedException {
+        CountDownLatch prepared = new CountDownLatch(1);
+        AtomicInteger result = new AtomicInteger(-1);
+        player.setOnPreparedListener((p, r) -> {
+            result.set(r);
+            prepared.countDown();
+        });
+        player.prepare();
+        assertTrue("prepare timed out", prepared.await(10, TimeUnit.SECONDS));
+        assertEquals("prepare failed", 0, result.get());
+
+        player.start();
+        assertEquals(Player.PlayerState.Playing, player.getState());
+        player.stop();
+        assertEquals(Player.PlayerState.End, player.getState());
+    }
+
+    // 停止后的线程退出和关闭可能稍有延迟，最多等 5 秒降到 limit 以下
+    private static int waitForCount(String dir, int limit) throws InterruptedException {
+        int count = countEntries(dir);
+        for (int i = 0; i < 50 && count > limit; i++) {
+            Thread.sleep(100);
+            count = countEntries(dir);
+        }
+        return count;
+    }
+
+    private static int countEntries(String dir) {
+        String[] names = new File(dir).list();
+        return names == null ? 0 : names.length;
+    }
+}
@@ -0,0 +1,140 @@
+package com.example.androidplayer;
+
+import android.graphics.SurfaceTexture;
+import android.util.Log;
+import android.view.Surface;
+
+import androidx.test.ext.junit.runners.AndroidJUnit4;
+
+import org.junit.After;
+import org.junit.Before;
+import org.junit.BeforeClass;
+import org.junit.Test;
+import org.junit.runner.RunWith;
+
+import java.io.File;
+import java.util.concurrent.CountDownLatch;
+import java.util.concurrent.TimeUnit;
+import java.util.concurrent.atomic.AtomicInteger;
+import java.util.regex.Matcher;
+import java.util.regex.Pattern;
+
+import static org.junit.Assert.*;
+import static org.junit.Assume.assumeTrue;
+
+/**
+ * 倒放的持续帧率：先测正放 1x 的帧率，再从接近结尾处倒放 1x、2x，结果打到 logcat（tag ReverseBenchmark）。
+ * 需要设备上有至少 40 秒的 /sdcard/testfile.mp4，没有时跳过。
+ */
+@RunWith(AndroidJUnit4.class)
+public class ReversePlaybackBenchmarkTest {
+    private static final String TAG = "ReverseBenchmark";
+    private static final String TEST_FILE = "/sdcard/testfile.mp4";
+    private static final long WARMUP_MS = 1000;
+    private static final long FORWARD_MS = 3000;
+    private static final long MEASURE_MS = 5000;
+    // 倒放允许比正放慢的比例
+    private static final double MIN_RATIO = 0.8;
+
+    private static final Pattern DECODE = Pattern.compile("decode: (\\d+) frames");
+    private static final Pattern REVERSE = Pattern.compile("reverse: (\\d+) shown, (\\d+) decoded");
+
+    private SurfaceTexture texture;
+    private Surface surface;
+
+    @BeforeClass
+    public static void loadLibrary() {
+        System.loadLibrary("androidplayer");
+    }
+
+    @Before
+    public void setUp() {
+        assumeTrue("missing " + TEST_FILE, new File(TEST_FILE).canRead());
+        Player.setStandbyCache(0, 0);
+        texture = new SurfaceTexture(false);
+        texture.setDefaultBufferSize(640, 360);
+        surface = new Surface(texture);
+    }
+
+    @After
+    public void tearDown() {
+        if (surface != null) surface.release();
+        if (texture != null) texture.release();
+    }
+
+    @Test
+    public void reverseSustainsForwardFrameRate() throws Exception {
+        Player player = new Player();
+        player.setDataSource("file:" + TEST_FILE);
+        player.setSurface(surface);
+
+        CountDownLatch prepared = new CountDownLatch(1);
+        AtomicInteger result = new AtomicInteger(-1);
+        player.setOnPreparedListener((p, r) -> {
+            result.set(r);
+            prepared.countDown();
+        });
+
+        double forward, reverse1x, reverse2x;
+        long shown, decoded;
+        try {
+            player.prepare();
+            assertTrue("prepare timed out", prepared.await(10, TimeUnit.SECONDS));
+            assertEquals("prepare failed", 0, result.get());
+            player.start();
+
+            // 正放时解码被帧队列限速，稳定后的解码帧率就是显示帧率
+            Thread.sleep(WARMUP_MS);
+            forward = rate(player, DECODE, FORWARD_MS);
+            // 倒放 1x 和 2x 一共要回退 20 秒左右
+            assumeTrue("file too short", player.getProgress() < 0.1);
+
+            player.seek(0.9);
+            Thread.sleep(WARMUP_MS);
+            player.setSpeed(-1);
+            assertEquals(Player.PlayerState.Playing, player.getState());
+            Thread.sleep(WARMUP_MS);
+            reverse1x = rate(player, REVERSE, MEASURE_MS);
+
+            player.setSpeed(-2);
+            Thread.sleep(WARMUP_MS);
+            reverse2x = rate(player, REVERSE, MEASURE_MS);
+
+            Matcher m = REVERSE.matcher(player.getStats());
+            assertTrue(m.find());
+            shown = Long.parseLong(m.group(1));
+            decoded = Long.parseLong(m.group(2));
+        } finally {
+            player.stop();
+            player.release();
+        }
+
+        Log.i(TAG, String.format("forward %.1f fps, reverse 1x %.1f fps (%.0f%%), reverse 2x %.1f fps (%.0f%% of 2x), "
+                        + "%d shown, %d decoded (%.2f decodes per frame)",
+                forward, reverse1x, reverse1x * 100 / forward, reverse2x, reverse2x * 100 / (2 * forward),
+                shown, decoded, shown > 0 ? decoded / (double) shown : 0.0));
+
+        assertTrue("forward played nothing", forward > 0);
+        assertTrue(String.format("reverse 1x %.1f fps, forward %.1f fps", reverse1x, forward),
+                reverse1x >= forward * MIN_RATIO);
+        // 2x 至少不能比 1x 慢
+        assertTrue(String.format("reverse 2x %.1f fps, reverse 1x %.1f fps", reverse2x, reverse1x),
+                reverse2x >= reverse1x * MIN_RATIO);
+    }
+
+    // 计数器在 window 毫秒内的增长速度（每秒）
+    private static double rate(Player player, Pattern counter, long window) throws InterruptedException {
+        long start = count(player, counter);
+        long begin = System.nanoTime();
+        Thread.sleep(window);
+        long end = count(player, counter);
+        return (end - start) * 1e9 / (System.nanoTime() - begin);
+    }
+
+    private static long count(Player player, Pattern counter) {
+        String stats = player.getStats();
+        Matcher m = counter.matcher(stats);
+        assertTrue("unexpected stats: " + stats, m.find());
+        return Long.parseLong(m.group(1));
+    }
+}
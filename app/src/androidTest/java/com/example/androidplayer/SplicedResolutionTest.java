@@ -0,0 +1,118 @@
+package com.example.androidplayer;
+
+import android.graphics.SurfaceTexture;
+import android.view.Surface;
+
+import androidx.test.ext.junit.runners.AndroidJUnit4;
+
+import org.junit.After;
+import org.junit.Before;
+import org.junit.BeforeClass;
+import org.junit.Test;
+import org.junit.runner.RunWith;
+
+import java.io.File;
+import java.util.concurrent.CountDownLatch;
+import java.util.concurrent.TimeUnit;
+import java.util.concurrent.atomic.AtomicInteger;
+import java.util.regex.Matcher;
+import java.util.regex.Pattern;
+
+import static org.junit.Assert.*;
+import static org.junit.Assume.assumeTrue;
+
+/**
+ * 播放中途切换分辨率的拼接文件：每次切换都要重新取转换上下文，切回第一段时命中缓存，而且每一帧都转换成功。
+ * 需要设备上有 /sdcard/spliced.ts，没有时跳过。三段各 3 秒，640x360 → 1280x720 → 640x360，例如：
+ *   for s in 640x360 1280x720; do ffmpeg -f lavfi -i testsrc2=s=$s:r=30:d=3 -f lavfi -i sine=d=3 \
+ *       -c:v libx264 -g 30 -c:a aac $s.ts; done
+ *   printf "file %s\n" 640x360.ts 1280x720.ts 640x360.ts > list.txt
+ *   ffmpeg -f concat -i list.txt -c copy spliced.ts
+ */
+@RunWith(AndroidJUnit4.class)
+public class SplicedResolutionTest {
+    private static final String TEST_FILE = "/sdcard/spliced.ts";
+    private static final long PLAY_TIMEOUT_MS = 30000;
+
+    private static final Pattern CACHE = Pattern.compile("convert cache: (\\d+) hits, (\\d+) misses");
+    private static final Pattern DECODE = Pattern.compile("decode: (\\d+) frames");
+    private static final Pattern CONVERT = Pattern.compile("convert: \\S+ x\\d+ slices, (\\d+) frames");
+    private static final Pattern ELIDED = Pattern.compile("static frames: (\\d+) elided");
+
+    private SurfaceTexture texture;
+    private Surface surface;
+
+    @BeforeClass
+    public static void loadLibrary() {
+        System.loadLibrary("androidplayer");
+    }
+
+    @Before
+    public void setUp() {
+        assumeTrue("missing " + TEST_FILE, new File(TEST_FILE).canRead());
+        Player.setStandbyCache(0, 0);
+        texture = new SurfaceTexture(false);
+        texture.setDefaultBufferSize(640, 360);
+        surface = new Surface(texture);
+    }
+
+    @After
+    public void tearDown() {
+        if (surface != null) surface.release();
+        if (texture != null) texture.release();
+    }
+
+    @Test
+    public void everyRenditionConvertsAndReturningHitsTheCache() throws Exception {
+        Player player = new Player();
+        player.setDataSource("file:" + TEST_FILE);
+        player.setSurface(surface);
+
+        CountDownLatch prepared = new CountDownLatch(1);
+        AtomicInteger result = new AtomicInteger(-1);
+        player.setOnPreparedListener((p, r) -> {
+            result.set(r);
+            prepared.countDown();
+        });
+
+        String stats;
+        try {
+            player.prepare();
+            assertTrue("prepare timed out", prepared.await(10, TimeUnit.SECONDS));
+            assertEquals("prepare failed", 0, result.get());
+            player.start();
+
+            // 播到第三段（切回 640x360）之后再停
+            long deadline = System.currentTimeMillis() + PLAY_TIMEOUT_MS;
+            while (player.getProgress() < 0.9 && System.currentTimeMillis() < deadline) {
+                Thread.sleep(200);
+            }
+            stats = player.getStats();
+        } finally {
+            player.stop();
+            player.release();
+        }
+
+        Matcher cache = CACHE.matcher(stats);
+        assertTrue("unexpected stats: " + stats, cache.find());
+        long hits = Long.parseLong(cache.group(1));
+        long misses = Long.parseLong(cache.group(2));
+        // 两种分辨率各建一次，切回第一段时复用
+        assertTrue("convert cache misses " + misses, misses >= 2);
+        assertTrue("convert cache hits " + hits, hits >= 1);
+
+        long decoded = parse(DECODE, stats);
+        long converted = parse(CONVERT, stats);
+        long elided = parse(ELIDED, stats);
+        // 三段都解码到了，而且切换前后没有因为格式不支持被丢掉的帧；最后几帧可能还在队列里
+        assertTrue("decoded only " + decoded + " frames", decoded > 180);
+        assertTrue("converted " + converted + " + elided " + elided + " of " + decoded,
+                converted + elided >= decoded - 8);
+    }
+
+    private static long parse(Pattern pattern, String stats) {
+        Matcher m = pattern.matcher(stats);
+        assertTrue("unexpected stats: " + stats, m.find());
+        return Long.parseLong(m.group(1));
+    }
+}
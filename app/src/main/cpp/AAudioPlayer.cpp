@@ -10,11 +10,14 @@
 #include <mutex>
 #include <condition_variable>
 #include "timer.h"
+#include "playbackControl.h"
+#include "playerStats.h"
 
 double getAudioClock(AAudioStream *pStruct);
 
 // 播放音频数据的线程函数
-void AAudioPlayerThread(AudioRingBuffer* ringBuffer) {
+void AAudioPlayerThread(AudioRingBuffer* ringBuffer, PlaybackControl* control, Timer* timer, PlayerStats* stats) {
+    PlayerStats::ThreadScope cpuScope(stats);
     AAudioStream* stream = nullptr;
 
     LOGI("🔊 Starting AAudio player thread");
@@ -41,8 +44,14 @@ void AAudioPlayerThread(AudioRingBuffer* ringBuffer) {
     AAudioStreamBuilder_setPerformanceMode(builder, AAUDIO_PERFORMANCE_MODE_LOW_LATENCY);
 
 
-    // 尝试打开音频流
+    // 尝试打开音频流；builder 只用于打开，每次播放都要释放
     aaudio_result_t result1 = AAudioStreamBuilder_openStream(builder, &stream);  // 改为 aaudio_result_t
+    AAudioStreamBuilder_delete(builder);
+
+    if (result1 != AAUDIO_OK) {
+        LOGE("❌ Failed to open AAudio stream: %s", AAudio_convertResultToText(result1));
+        return;
+    }
 
     LOGI("🎛 Opened stream info:");
     LOGI("   Sample rate: %d", AAudioStream_getSampleRate(stream));
@@ -51,33 +60,57 @@ void AAudioPlayerThread(AudioRingBuffer* ringBuffer) {
     LOGI("   Buffer capacity: %d", AAudioStream_getBufferCapacityInFrames(stream));
     LOGI("   Frames per burst: %d", AAudioStream_getFramesPerBurst(stream));
 
-    AAudioStream_requestStart(stream);
-
-    if (result1 != AAUDIO_OK) {
-        LOGE("❌ Failed to open AAudio stream: %s", AAudio_convertResultToText(result));
-        return;
-    }
-
     LOGI("✅ AAudio stream successfully opened");
 
-    AAudioStream_requestStart(stream);
-
     const int bufferSize = 2048;
     uint8_t buffer[bufferSize];
 
-    while (true) {
-        if (!Timer::isPlaying){
-            return;
+    // 预滚动：流打开后先写入第一段音频（未启动的流可以预先写入），start 时设备直接从这段开始播放
+    bool started = false;
+    if (control->isPrerolling()) {
+        size_t bytesRead = ringBuffer->read(buffer, bufferSize);
+        if (bytesRead > 0) AAudioStream_write(stream, buffer, bytesRead / (2 * sizeof(int16_t)), 0);
+        control->prerollDone();
+    }
+
+    // 音频时钟 = 已写入帧数换算的时间 + 偏移，跳转后把偏移对齐到跳转目标
+    int serial = control->getSerial();
+    double clockOffset = 0.0;
+
+    while (!control->isStopped()) {
+        stats->audioOutputWakeups++;
+        // 暂停：停下音频设备，阻塞到恢复；已写入设备的数据保留，恢复时从下一个采样继续
+        if (control->isPaused()) {
+            if (started) AAudioStream_requestPause(stream);
+            int pausedSerial = control->getSerial();
+            if (!control->waitUntilResumed()) break;
+            // 暂停期间跳转过：丢掉设备里旧位置的音频（只有暂停的流可以 flush）
+            if (started && control->getSerial() != pausedSerial) AAudioStream_requestFlush(stream);
+            AAudioStream_requestStart(stream);
+            started = true;
+            continue;
         }
+        if (!started) {
+            AAudioStream_requestStart(stream);
+            started = true;
+        }
+
         size_t bytesRead = ringBuffer->read(buffer, bufferSize);
+        int seekSerial;
+        double seekTarget;
+        control->getSeek(seekSerial, seekTarget);
+        if (seekSerial != serial) {
+            serial = seekSerial;
+            clockOffset = seekTarget - getAudioClock(stream);
+        }
         if (bytesRead > 0) {
             int framesToWrite = bytesRead / (2 * sizeof(int16_t)); // stereo, 16-bit
 
             // 倍速播放
             double speed = 1.0; // 播放倍速
 
-            double time_sec = getAudioClock(stream);
-            double master_time = Timer::getCurrentTime(); // 主时钟 ⏱️
+            double time_sec = getAudioClock(stream) + clockOffset;
+            double master_time = timer->getCurrentTime(); // 主时钟 ⏱️
             double delay = time_sec - master_time;
 
             // 打印调试时间戳
@@ -92,7 +125,8 @@ void AAudioPlayerThread(AudioRingBuffer* ringBuffer) {
                 speed = 2.0; // 播放倍速
             } else if (delay > 0.2) {
                 // 如果时间还没到，睡一小会儿等它到点再播放
-                std::this_thread::sleep_for(std::chrono::milliseconds((int)(delay * 1000 * 2))); // 加倍延迟
+                // 跳转或停止时立即醒来
+                control->sleepFor(delay * 2, serial); // 加倍延迟
             }
 
 
@@ -102,14 +136,12 @@ void AAudioPlayerThread(AudioRingBuffer* ringBuffer) {
 
             AAudioStream_write(stream, buffer, framesToWrite, actualDelay * 1e9);
             // 计算当前音频PTS
-            double audioPts = getAudioClock(stream);
+            double audioPts = getAudioClock(stream) + clockOffset;
             LOGD("🎧 Audio PTS: %.3f sec", audioPts);
         } else {
-            if (ringBuffer->isFinished() && ringBuffer->isEmpty()) {
-                LOGI("🎉 Audio ring buffer fully played!");
-                break;
-            }
-            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            // read 阻塞到有数据，只有结束后才返回 0
+            LOGI("🎉 Audio ring buffer fully played!");
+            break;
         }
     }
 
@@ -0,0 +1,179 @@
+//
+// abLoop.cpp
+//
+
+#include "abLoop.h"
+#include "log.h"
+#define TAG "abLoop"
+
+#include <cmath>
+#include <cstring>
+
+// 缓存的压缩包上限，超过后退回到每一遍都从文件读
+static const size_t maxCacheBytes = 64 << 20;
+
+static int64_t toStreamTime(double seconds, AVRational tb) {
+    return llrint(seconds / av_q2d(tb));
+}
+
+AbLoop::AbLoop(AVFormatContext* formatCtx, int videoStreamIndex, int audioStreamIndex, PlayerStats* stats)
+        : formatCtx(formatCtx), videoStreamIndex(videoStreamIndex), audioStreamIndex(audioStreamIndex), stats(stats) {}
+
+AbLoop::~AbLoop() {
+    freeCache();
+}
+
+void AbLoop::freeCache() {
+    for (AVPacket* pkt : cache) av_packet_free(&pkt);
+    cache.clear();
+    cacheBytes = 0;
+    cached = false;
+}
+
+void AbLoop::reset(bool enabled, double loopStart, double loopEnd, double target) {
+    freeCache();
+    active = enabled;
+    start = loopStart;
+    end = loopEnd;
+    iteration = 0;
+    overflowed = false;
+    videoDone = false;
+    audioDone = audioStreamIndex < 0;
+    passPackets = 0;
+    if (!active) return;
+
+    AVRational videoTb = formatCtx->streams[videoStreamIndex]->time_base;
+    videoStart = toStreamTime(start, videoTb);
+    videoEnd = toStreamTime(end, videoTb);
+    if (audioStreamIndex >= 0) {
+        AVRational audioTb = formatCtx->streams[audioStreamIndex]->time_base;
+        audioStart = toStreamTime(start, audioTb);
+        audioEnd = toStreamTime(end, audioTb);
+    }
+    caching = target <= start;
+    passStart = caching ? start : target;
+    markPending = audioStreamIndex >= 0;
+    LOGI("🔁 A-B loop %.3f - %.3f", start, end);
+}
+
+bool AbLoop::isActive() const {
+    return active;
+}
+
+bool AbLoop::isCached() const {
+    return active && cached;
+}
+
+bool AbLoop::passFinished() const {
+    return (videoDone || videoDiscarded) && audioDone;
+}
+
+void AbLoop::setVideoDiscarded(bool discarded) {
+    videoDiscarded = discarded;
+}
+
+int64_t AbLoop::offsetFor(int streamIndex) const {
+    return toStreamTime(iteration * (end - start), formatCtx->streams[streamIndex]->time_base);
+}
+
+void AbLoop::applyOffset(AVPacket* pkt) const {
+    if (iteration == 0) return;
+    int64_t offset = offsetFor(pkt->stream_index);
+    if (pkt->pts != AV_NOPTS_VALUE) pkt->pts += offset;
+    if (pkt->dts != AV_NOPTS_VALUE) pkt->dts += offset;
+}
+
+// 这一遍的第一个音频包告诉音频解码从哪里开始、到哪里为止，包边界和 A/B 不对齐的部分按采样丢弃
+void AbLoop::markPassStart(AVPacket* pkt) {
+    if (!markPending || pkt->stream_index != audioStreamIndex) return;
+    markPending = false;
+    double offset = iteration * (end - start);
+    av_buffer_unref(&pkt->opaque_ref);
+    pkt->opaque_ref = av_buffer_alloc(sizeof(LoopMark));
+    if (!pkt->opaque_ref) return;
+    LoopMark mark = {passStart + offset, end + offset};
+    memcpy(pkt->opaque_ref->data, &mark, sizeof(mark));
+}
+
+bool AbLoop::filter(AVPacket* pkt) {
+    if (pkt->stream_index == videoStreamIndex) {
+        if (videoDone) return false;
+        int64_t dts = pkt->dts != AV_NOPTS_VALUE ? pkt->dts : pkt->pts;
+        if (dts != AV_NOPTS_VALUE && dts >= videoEnd) {
+            videoDone = true;
+            return false;
+        }
+        // 解码顺序在 B 之前、显示在 B 之后，或者 A 之前的预解码帧：要解码，但不显示
+        if (pkt->pts != AV_NOPTS_VALUE && (pkt->pts >= videoEnd || pkt->pts < videoStart)) {
+            pkt->flags |= AV_PKT_FLAG_DISCARD;
+        }
+    } else if (pkt->stream_index == audioStreamIndex) {
+        if (audioDone) return false;
+        if (pkt->pts != AV_NOPTS_VALUE && pkt->pts >= audioEnd) {
+            audioDone = true;
+            return false;
+        }
+        // 包含 A 的包要送去解码，音频解码从 A 开始输出；时长未知时只能按起点判断
+        int64_t pktEnd = pkt->pts + (pkt->duration > 0 ? pkt->duration : 1);
+        if (pkt->pts != AV_NOPTS_VALUE && pktEnd <= audioStart) return false;
+    } else {
+        return false;
+    }
+
+    if (caching) {
+        cacheBytes += pkt->size;
+        if (cacheBytes > maxCacheBytes) {
+            LOGI("🔁 Loop range exceeds %zu bytes, re-reading from file each pass", maxCacheBytes);
+            freeCache();
+            caching = false;
+            overflowed = true;
+        } else {
+            cache.push_back(av_packet_clone(pkt));
+        }
+    }
+
+    applyOffset(pkt);
+    markPassStart(pkt);
+    passPackets++;
+    return true;
+}
+
+bool AbLoop::wrap() {
+    if (passPackets == 0) return false;
+    passPackets = 0;
+
+    if (caching) {
+        cached = true;
+        caching = false;
+        LOGI("🔁 Loop cached: %zu packets, %zu bytes", cache.size(), cacheBytes);
+    }
+    iteration++;
+    stats->loopWraps++;
+    passStart = start;
+    markPending = audioStreamIndex >= 0;
+    if (cached) {
+        passPackets = (int) cache.size();
+        return true;
+    }
+
+    // 第一遍是从区间中间开始的（或缓存放不下）：回到 A 之前的关键帧从文件读
+    int64_t ts = (int64_t) (start * AV_TIME_BASE);
+    if (avformat_seek_file(formatCtx, -1, INT64_MIN, ts, ts, 0) < 0) {
+        LOGE("❌ Loop seek to %.3f failed", start);
+    }
+    videoDone = false;
+    audioDone = audioStreamIndex < 0;
+    caching = !overflowed;
+    return true;
+}
+
+bool AbLoop::replay(const std::function<bool(AVPacket*)>& push) {
+    for (AVPacket* cachedPkt : cache) {
+        AVPacket* pkt = av_packet_clone(cachedPkt);
+        applyOffset(pkt);
+        markPassStart(pkt);
+        if (!push(pkt)) return false;
+    }
+    stats->loopReplayedPasses++;
+    return wrap();
+}
@@ -8,6 +8,16 @@
 #include "packetQueue.h"
 #include "audioRingBuffer.h"
 #include "timer.h"
+#include "playbackControl.h"
+#include "taskScheduler.h"
+#include "playerStats.h"
+#include "standbyCache.h"
+#include "abLoop.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <memory>
 
 extern "C" {
 #include <libavcodec/avcodec.h>
@@ -17,78 +27,178 @@ extern "C" {
 #include <libavutil/channel_layout.h>
 }
 
-void audioDecodeThread(PacketQueue* packetQueue, AudioRingBuffer* ringBuffer, AVCodecParameters* codecpar) {
-    LOGI("🔊 Starting audio decoder thread");
+// 每一步最多解码这么多个包，然后让出工作线程
+static const int packetsPerStep = 8;
+// swresample 支持的最大声道数
+static const int maxPlanes = 64;
+
+// 音频解码任务：每一步解码若干个包写入环形缓冲区，队列空时交还工作线程，有新包时被唤醒
+class AudioDecodeTask : public Task {
+public:
+    AudioDecodeTask(PacketQueue* packetQueue, AudioRingBuffer* ringBuffer, size_t ringAhead,
+                    AVCodecParameters* codecpar, AVRational timeBase, PlaybackControl* control, Timer* timer,
+                    PlayerStats* stats, StandbyEntry* standby)
+            : packetQueue(packetQueue), ringBuffer(ringBuffer), ringAhead(ringAhead), codecpar(codecpar),
+              timeBase(timeBase), control(control), timer(timer), stats(stats), standby(standby) {}
+
+    ~AudioDecodeTask() override {
+        close();
+    }
 
-    const AVCodec* codec = avcodec_find_decoder(codecpar->codec_id);
-    if (!codec) {
-        LOGE("❌ Audio decoder not found");
-        return;
+    Status step() override {
+        PlayerStats::CpuSpan cpuSpan(stats->taskCpuUs);
+        stats->audioDecodeWakeups++;
+        if (control->isStopped()) return finish();
+        if (!codecCtx && !open()) return finish();
+
+        for (int i = 0; i < packetsPerStep; i++) {
+            // 环形缓冲区到水位（包括暂停时音频设备不再读）就停下，AAudio 读到水位以下时唤醒
+            if (ringBuffer->buffered() > ringAhead) return Status::Blocked;
+            AVPacket* pkt = packetQueue->tryPop();
+            if (!pkt) return Status::Blocked;
+            decode(pkt);
+        }
+        return Status::Yield;
     }
 
-    AVCodecContext* codecCtx = avcodec_alloc_context3(codec);
-    avcodec_parameters_to_context(codecCtx, codecpar);
-    avcodec_open2(codecCtx, codec, nullptr);
+private:
+    bool open() {
+        LOGI("🔊 Starting audio decoder");
 
-    LOGI("🎧 Input Audio Info: sample_rate=%d, channels=%d, format=%d",
-         codecCtx->sample_rate, codecCtx->ch_layout.nb_channels, codecCtx->sample_fmt);
+        const AVCodec* codec = avcodec_find_decoder(codecpar->codec_id);
+        if (!codec) {
+            LOGE("❌ Audio decoder not found");
+            return false;
+        }
 
-    SwrContext* swrCtx = nullptr;
-    AVChannelLayout outChLayout = AV_CHANNEL_LAYOUT_STEREO;
+        // 热备缓存里同一个文件上次打开的解码器，冲刷后直接用
+        if (standby && standby->audioCodecCtx) {
+            codecCtx = standby->audioCodecCtx;
+            standby->audioCodecCtx = nullptr;
+            avcodec_flush_buffers(codecCtx);
+            LOGI("🧊 Reusing standby audio decoder");
+        } else {
+            codecCtx = avcodec_alloc_context3(codec);
+            avcodec_parameters_to_context(codecCtx, codecpar);
+            codecCtx->pkt_timebase = timeBase;
+            avcodec_open2(codecCtx, codec, nullptr);
+        }
 
-//    LOGD("🎧 swr_alloc_set_opts2 configuration: ");
-//    LOGD("  Input channel layout: %llu", codecCtx->ch_layout.u.mask); // 打印输入的通道布局
-//    LOGD("  Input sample format: %d", codecCtx->sample_fmt); // 打印输入格式
-//    LOGD("  Input sample rate: %d", codecCtx->sample_rate); // 打印输入采样率
-//
-//    LOGD("  Output channel layout: %llu", outChLayout.u.mask); // 输出布局，假设为立体声
-//    LOGD("  Output sample format: %d", AV_SAMPLE_FMT_S16); // 输出格式，假设为 S16
-//    LOGD("  Output sample rate: %d", 44100); // 假设输出采样率和输入相同
-    int ret = swr_alloc_set_opts2(&swrCtx,
-                                  &outChLayout,   // 输出 layout
-                                  AV_SAMPLE_FMT_S16,         // 输出格式
-                                  44100,                // 输出采样率
-                                  &codecCtx->ch_layout,      // 输入 layout
-                                  codecCtx->sample_fmt,      // 输入格式
-                                  codecCtx->sample_rate,     // 输入采样率
-                                  0, nullptr);
-
-    if (ret < 0 || !swrCtx || swr_init(swrCtx) < 0) {
-        LOGE("❌ Failed to initialize swrCtx");
-        return;
-    } else {
-        LOGI("✅ swrCtx initialized successfully");
+        LOGI("🎧 Input Audio Info: sample_rate=%d, channels=%d, format=%d",
+             codecCtx->sample_rate, codecCtx->ch_layout.nb_channels, codecCtx->sample_fmt);
+
+        AVChannelLayout outChLayout = AV_CHANNEL_LAYOUT_STEREO;
+        int ret = swr_alloc_set_opts2(&swrCtx,
+                                      &outChLayout,   // 输出 layout
+                                      AV_SAMPLE_FMT_S16,         // 输出格式
+                                      44100,                // 输出采样率
+                                      &codecCtx->ch_layout,      // 输入 layout
+                                      codecCtx->sample_fmt,      // 输入格式
+                                      codecCtx->sample_rate,     // 输入采样率
+                                      0, nullptr);
+
+        if (ret < 0 || !swrCtx || swr_init(swrCtx) < 0) {
+            LOGE("❌ Failed to initialize swrCtx");
+            avcodec_free_context(&codecCtx);
+            return false;
+        } else {
+            LOGI("✅ swrCtx initialized successfully");
+        }
+
+        frame = av_frame_alloc();
+        outBuffer = (uint8_t*) av_malloc(192000);  // 最大缓冲
+        serial = control->getSerial();
+        return true;
     }
 
-    AVFrame* frame = av_frame_alloc();
-    AVPacket* pkt = nullptr;
+    void close() {
+        av_freep(&outBuffer);
+        av_frame_free(&frame);
+        swr_free(&swrCtx);
+        // 停止后交还给热备条目，由 NativePlayer 决定留下还是释放
+        if (standby && codecCtx) {
+            standby->audioCodecCtx = codecCtx;
+            codecCtx = nullptr;
+        }
+        avcodec_free_context(&codecCtx);
+    }
 
-    uint8_t* outBuffer = (uint8_t*) av_malloc(192000);  // 最大缓冲
+    Status finish() {
+        close();
+        LOGI("🛑 Audio decoder finished");
+        return Status::Done;
+    }
 
-    while (!(packetQueue->isFinished() && packetQueue->empty())) {
-        if (!Timer::isPlaying){
+    void decode(AVPacket* pkt) {
+        int seekSerial;
+        double seekTarget;
+        control->getSeek(seekSerial, seekTarget);
+        if (seekSerial != serial) {
+            serial = seekSerial;
+            avcodec_flush_buffers(codecCtx);
+            ringBuffer->clear();
+            skipUntil = seekTarget;
+            passRemaining = -1;
+        }
+        if (serialOf(pkt->opaque) != serial) {
+            av_packet_free(&pkt);
             return;
         }
-        pkt = packetQueue->pop();
-        if (!pkt) continue;
 
         LOGD("📦 Audio packet pts=%lld size=%d", pkt->pts, pkt->size);
 
-        if (avcodec_send_packet(codecCtx, pkt) < 0) {
+        // 文件结束：排空解码器，然后等跳转后的新包
+        bool endOfStream = isEndOfStream(pkt);
+
+        // 高倍速静音，不解码（A-B 循环时解复用仍会送来音频包）
+        if (!endOfStream && control->getTrickMode() == TrickMode::Keyframes) {
+            av_packet_free(&pkt);
+            return;
+        }
+        if (avcodec_send_packet(codecCtx, endOfStream ? nullptr : pkt) < 0) {
             LOGE("❌ Failed to send packet to decoder");
             av_packet_free(&pkt);
-            continue;
+            return;
         }
+        // A-B 循环新的一遍：从 A 开始，按采样数输出到 B 为止。这个包之前送入的包解码出的帧已经在上一遍里取完
+        LoopMark mark = {};
+        bool passStart = pkt->opaque_ref && pkt->opaque_ref->size == sizeof(LoopMark);
+        if (passStart) memcpy(&mark, pkt->opaque_ref->data, sizeof(mark));
         av_packet_free(&pkt);
 
         while (avcodec_receive_frame(codecCtx, frame) == 0) {
-            double pts_seconds = frame->pts * av_q2d(codecCtx->time_base);
+            double pts_seconds = frame->pts * av_q2d(timeBase);
+            int rate = codecCtx->sample_rate;
 
             LOGD("🧩 Decoded frame: nb_samples=%d, channels=%d, format=%d, time=%.3f",
                  frame->nb_samples, frame->ch_layout.nb_channels, frame->format, pts_seconds);
 
-            int outSamples = swr_convert(swrCtx, &outBuffer, 192000,
-                                         (const uint8_t **)frame->data, frame->nb_samples);
+            if (passStart) {
+                passStart = false;
+                skipUntil = mark.start;
+                // 都按绝对位置取整，每一遍的舍入误差不会累积
+                passRemaining = std::max<int64_t>(0, llrint(mark.end * rate) - llrint(mark.start * rate));
+            }
+
+            // 跳转目标或循环起点之前的采样：整帧丢弃，跨过起点的帧从起点那个采样开始
+            int offset = 0;
+            if (skipUntil >= 0 && frame->pts != AV_NOPTS_VALUE) {
+                int64_t skip = llrint(skipUntil * rate) - llrint(pts_seconds * rate);
+                if (skip >= frame->nb_samples) continue;
+                offset = (int) std::max<int64_t>(0, skip);
+                skipUntil = -1;
+            }
+            int count = frame->nb_samples - offset;
+            // 循环这一遍已经输出到 B：剩下的采样丢弃，等下一遍的起点
+            if (passRemaining >= 0) {
+                count = (int) std::min<int64_t>(count, passRemaining);
+                passRemaining -= count;
+                if (count <= 0) continue;
+            }
+
+            const uint8_t* in[maxPlanes];
+            sampleOffset(frame, offset, in);
+            int outSamples = swr_convert(swrCtx, &outBuffer, 192000, in, count);
 
             if (outSamples <= 0) {
                 LOGE("❌ swr_convert failed or returned 0 samples");
@@ -102,14 +212,43 @@ void audioDecodeThread(PacketQueue* packetQueue, AudioRingBuffer* ringBuffer, AV
             ringBuffer->write(outBuffer, outSize);
             LOGD("💾 PCM written to ringBuffer, size=%d", outSize);
         }
-
     }
 
-    av_free(outBuffer);
-    av_frame_free(&frame);
-    swr_free(&swrCtx);
-    avcodec_free_context(&codecCtx);
+    // 从第 offset 个采样开始的输入指针，平面格式每个声道一个
+    static void sampleOffset(const AVFrame* frame, int offset, const uint8_t** in) {
+        AVSampleFormat format = (AVSampleFormat) frame->format;
+        int channels = frame->ch_layout.nb_channels;
+        bool planar = av_sample_fmt_is_planar(format);
+        int planes = planar ? channels : 1;
+        int stride = av_get_bytes_per_sample(format) * (planar ? 1 : channels);
+        for (int i = 0; i < planes && i < maxPlanes; i++) {
+            in[i] = frame->extended_data[i] + (ptrdiff_t) offset * stride;
+        }
+    }
 
-    LOGI("🛑 Audio decoder finished");
-    ringBuffer->setFinished(true);
+    PacketQueue* packetQueue;
+    AudioRingBuffer* ringBuffer;
+    size_t ringAhead;          // 环形缓冲区的水位（字节）
+    AVCodecParameters* codecpar;
+    AVRational timeBase;
+    PlaybackControl* control;
+    Timer* timer;
+    PlayerStats* stats;
+    StandbyEntry* standby;     // 关闭热备缓存时为空
+
+    AVCodecContext* codecCtx = nullptr;
+    SwrContext* swrCtx = nullptr;
+    AVFrame* frame = nullptr;
+    uint8_t* outBuffer = nullptr;
+    int serial = 0;
+    double skipUntil = -1; // 跳转后或循环每一遍开始时丢弃这个位置之前的采样
+    int64_t passRemaining = -1;  // A-B 循环这一遍还要输出的采样数（输入采样率），-1 表示不限
+};
+
+std::shared_ptr<Task> createAudioDecodeTask(PacketQueue* packetQueue, AudioRingBuffer* ringBuffer, size_t ringAhead,
+                                            AVCodecParameters* codecpar, AVRational timeBase,
+                                            PlaybackControl* control, Timer* timer, PlayerStats* stats,
+                                            StandbyEntry* standby) {
+    return std::make_shared<AudioDecodeTask>(packetQueue, ringBuffer, ringAhead, codecpar, timeBase, control, timer,
+                                             stats, standby);
 }
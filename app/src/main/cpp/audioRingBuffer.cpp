@@ -33,6 +33,7 @@ size_t AudioRingBuffer::read(uint8_t* out, size_t len) {
     std::unique_lock<std::mutex> lock(mutex);
     cond.wait(lock, [this]() { return size > 0 || finished; });
 
+    size_t before = size;
     size_t toRead = std::min(len, size);
     for (size_t i = 0; i < toRead; ++i) {
         out[i] = buffer[readPos];
@@ -40,7 +41,10 @@ size_t AudioRingBuffer::read(uint8_t* out, size_t len) {
         size--;
     }
     LOGD("🎵 Read %zu bytes from ringBuffer, current size=%zu", toRead, size);
+    bool crossed = before > lowWater && size <= lowWater;
+    lock.unlock();
 
+    if (crossed && onLowWater) onLowWater();
     return toRead;
 }
 
@@ -51,9 +55,12 @@ void AudioRingBuffer::clear() {
 }
 
 void AudioRingBuffer::setFinished(bool val) {
-    std::lock_guard<std::mutex> lock(mutex);
-    finished = val;
-    cond.notify_all();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        finished = val;
+        cond.notify_all();
+    }
+    if (onLowWater) onLowWater();
 }
 
 bool AudioRingBuffer::isFinished() {
@@ -65,3 +72,13 @@ bool AudioRingBuffer::isEmpty() {
     std::lock_guard<std::mutex> lock(mutex);
     return size == 0;
 }
+
+size_t AudioRingBuffer::buffered() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return size;
+}
+
+void AudioRingBuffer::setLowWaterListener(size_t bytes, std::function<void()> listener) {
+    lowWater = bytes;
+    onLowWater = std::move(listener);
+}
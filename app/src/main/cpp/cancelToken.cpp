@@ -0,0 +1,25 @@
+//
+// cancelToken.cpp
+//
+
+#include "cancelToken.h"
+
+void CancelToken::reset() {
+    cancelled = false;
+}
+
+void CancelToken::cancel() {
+    cancelled = true;
+}
+
+bool CancelToken::isCancelled() const {
+    return cancelled.load();
+}
+
+static int isInterrupted(void* opaque) {
+    return static_cast<const CancelToken*>(opaque)->isCancelled() ? 1 : 0;
+}
+
+AVIOInterruptCB CancelToken::interruptCallback() const {
+    return {isInterrupted, const_cast<CancelToken*>(this)};
+}
@@ -0,0 +1,121 @@
+//
+// decodeDegrader.cpp
+//
+
+#include "decodeDegrader.h"
+#include "log.h"
+#define TAG "decodeDegrader"
+
+#include <algorithm>
+
+using namespace std::chrono;
+
+// 进入各级别需要的落后秒数，以及恢复到上一级别前需要回落到的秒数（迟滞）
+static const double enterLag[DecodeDegrader::LEVEL_COUNT] = {0.0, 0.05, 0.15, 0.5};
+static const double exitLag[DecodeDegrader::LEVEL_COUNT]  = {0.0, 0.02, 0.08, 0.25};
+// 每一级至少保持的时间，避免在阈值附近来回抖动
+static const double holdSeconds = 0.5;
+
+static const char* levelNames[DecodeDegrader::LEVEL_COUNT] = {
+        "none", "skip_loop_filter", "skip_nonref", "skip_to_keyframe"
+};
+
+DecodeDegrader::DecodeDegrader() : levelSince(steady_clock::now()) {}
+
+void DecodeDegrader::update(AVCodecContext* codecCtx, double lag) {
+    // 落后加剧：直接升到满足阈值的最高级别
+    for (int l = LEVEL_COUNT - 1; l > level; --l) {
+        if (lag >= enterLag[l]) {
+            setLevel(codecCtx, (Level) l, lag);
+            return;
+        }
+    }
+
+    // 落后缓解：在当前级别保持足够久后逐级恢复
+    if (level > LEVEL_NONE && lag < exitLag[level]) {
+        double held = duration_cast<duration<double>>(steady_clock::now() - levelSince).count();
+        if (held >= holdSeconds) {
+            setLevel(codecCtx, (Level) (level - 1), lag);
+        }
+    }
+}
+
+void DecodeDegrader::reset(AVCodecContext* codecCtx) {
+    if (level != LEVEL_NONE) setLevel(codecCtx, LEVEL_NONE, 0.0);
+    applySkip(codecCtx);
+    waitingKeyframe = false;
+}
+
+void DecodeDegrader::setSkipFloor(AVCodecContext* codecCtx, AVDiscard skipFrame) {
+    skipFloor = skipFrame;
+    applySkip(codecCtx);
+}
+
+void DecodeDegrader::applySkip(AVCodecContext* codecCtx) const {
+    codecCtx->skip_loop_filter = level >= LEVEL_SKIP_LOOP_FILTER ? AVDISCARD_ALL : AVDISCARD_DEFAULT;
+    AVDiscard levelSkip = level >= LEVEL_SKIP_NONREF ? AVDISCARD_NONREF : AVDISCARD_DEFAULT;
+    codecCtx->skip_frame = std::max(levelSkip, skipFloor);
+}
+
+bool DecodeDegrader::shouldDropPacket(AVCodecContext* codecCtx, const AVPacket* pkt) {
+    if (level < LEVEL_SKIP_TO_KEYFRAME) return false;
+
+    if (pkt->flags & AV_PKT_FLAG_KEY) {
+        if (waitingKeyframe) {
+            // 中间丢过包，参考帧已不完整，从关键帧重新开始
+            avcodec_flush_buffers(codecCtx);
+            waitingKeyframe = false;
+        }
+        return false;
+    }
+
+    waitingKeyframe = true;
+    droppedPackets++;
+    return true;
+}
+
+void DecodeDegrader::onPacketSent() {
+    if (level >= LEVEL_SKIP_NONREF) sentPackets++;
+}
+
+void DecodeDegrader::onFrameReceived() {
+    if (level >= LEVEL_SKIP_NONREF) receivedFrames++;
+}
+
+DecodeDegrader::Level DecodeDegrader::getLevel() const {
+    return level;
+}
+
+void DecodeDegrader::setLevel(AVCodecContext* codecCtx, Level newLevel, double lag) {
+    accumulateLevelTime();
+
+    if (level >= LEVEL_SKIP_NONREF && newLevel < LEVEL_SKIP_NONREF) {
+        if (sentPackets > receivedFrames) discardedFrames += sentPackets - receivedFrames;
+        sentPackets = receivedFrames = 0;
+    }
+
+    LOGI("📉 Decode level %s -> %s (lag=%.3f)", levelNames[level], levelNames[newLevel], lag);
+    level = newLevel;
+
+    applySkip(codecCtx);
+    if (level < LEVEL_SKIP_TO_KEYFRAME) waitingKeyframe = false;
+}
+
+void DecodeDegrader::accumulateLevelTime() {
+    auto now = steady_clock::now();
+    timeAtLevel[level] += duration_cast<duration<double>>(now - levelSince).count();
+    levelSince = now;
+}
+
+void DecodeDegrader::logStats() {
+    accumulateLevelTime();
+
+    int64_t discarded = discardedFrames;
+    if (sentPackets > receivedFrames) discarded += sentPackets - receivedFrames;
+
+    for (int l = 0; l < LEVEL_COUNT; l++) {
+        LOGI("📊 Decode level %-16s: %.3f s", levelNames[l], timeAtLevel[l]);
+    }
+    LOGI("📊 Frames skipped: %lld (dropped packets=%lld, discarded by decoder=%lld)",
+         (long long) (droppedPackets + discarded), (long long) droppedPackets, (long long) discarded);
+}
@@ -4,17 +4,68 @@
 #define TAG "decoder"
 #include "packetQueue.h"
 #include "frameQueue.h"
+#include "decodeDegrader.h"
+#include "threadPolicy.h"
+#include "playerStats.h"
+#include "sliceConverter.h"
+#include "surfaceSize.h"
+#include "framePool.h"
+#include "frameCache.h"
+#include "playbackControl.h"
+#include "reverseDecoder.h"
+#include "speculativeDecoder.h"
+#include "frameDecimator.h"
+#include "staticFrameDetector.h"
+#include "standbyCache.h"
 
 extern "C" {
 #include <libavcodec/avcodec.h>
 #include <libavutil/imgutils.h>
-#include <libswscale/swscale.h>
 }
 
+#include <algorithm>
 #include <thread>
+#include <chrono>
 #include "timer.h"
 
-void decodeThread(PacketQueue* packetQueue, FrameQueue* frameQueue, AVCodecParameters* codecpar) {
+// 输出格式，改为 AV_PIX_FMT_RGB565 可减半转换写入和纹理上传带宽
+static const AVPixelFormat outputFormat = AV_PIX_FMT_RGBA;
+
+// 解码器支持 lowres 时，直接解码到不小于 Surface 的 1/2、1/4... 尺寸
+static int chooseLowres(const AVCodec* codec, const AVCodecParameters* codecpar, const SurfaceSize* surface) {
+    int surfaceWidth = surface->width;
+    int surfaceHeight = surface->height;
+    if (surfaceWidth <= 0 || surfaceHeight <= 0) return 0;
+
+    int lowres = 0;
+    while (lowres < codec->max_lowres &&
+           (codecpar->width >> (lowres + 1)) >= surfaceWidth &&
+           (codecpar->height >> (lowres + 1)) >= surfaceHeight) {
+        lowres++;
+    }
+    return lowres;
+}
+
+// 渲染时纹理会被拉伸铺满 Surface，所以每个方向都不需要超过 Surface 的像素
+static void fitToSurface(const AVFrame* frame, const SurfaceSize* surface, int& dstWidth, int& dstHeight) {
+    dstWidth = frame->width;
+    dstHeight = frame->height;
+    int surfaceWidth = surface->width;
+    int surfaceHeight = surface->height;
+    if (surfaceWidth > 0 && surfaceWidth < dstWidth) dstWidth = surfaceWidth & ~1;
+    if (surfaceHeight > 0 && surfaceHeight < dstHeight) dstHeight = surfaceHeight & ~1;
+}
+
+static int64_t elapsedUs(std::chrono::steady_clock::time_point since) {
+    using namespace std::chrono;
+    return duration_cast<microseconds>(steady_clock::now() - since).count();
+}
+
+void decodeThread(PacketQueue* packetQueue, FrameQueue* frameQueue, AVCodecParameters* codecpar, AVRational timeBase,
+                  bool lowLatency, const SurfaceSize* surfaceSize, PlaybackControl* control, Timer* timer,
+                  PlayerStats* stats, FrameCache* frameCache, SpeculativeDecoder* speculative, const char* path,
+                  StandbyEntry* standby) {
+    PlayerStats::ThreadScope cpuScope(stats);
     LOGI("🔧 Starting decoder thread");
 
     const AVCodec* codec = avcodec_find_decoder(codecpar->codec_id);
@@ -23,65 +74,394 @@ void decodeThread(PacketQueue* packetQueue, FrameQueue* frameQueue, AVCodecParam
         return;
     }
 
-    AVCodecContext* codecCtx = avcodec_alloc_context3(codec);
-    if (!codecCtx || avcodec_parameters_to_context(codecCtx, codecpar) < 0) {
-        LOGE("❌ Failed to create codec context");
-        return;
+    int lowres = chooseLowres(codec, codecpar, surfaceSize);
+    AVCodecContext* codecCtx = nullptr;
+    if (standby && standby->videoCodecCtx) {
+        // 热备缓存里同一个文件上次打开的解码器；Surface 尺寸变了、lowres 不同时只能重新打开
+        std::swap(codecCtx, standby->videoCodecCtx);
+        if (codecCtx->lowres == lowres) {
+            avcodec_flush_buffers(codecCtx);
+            codecCtx->skip_frame = AVDISCARD_DEFAULT;  // 上次停止时可能在拖动或后台只解关键帧
+            codecCtx->skip_loop_filter = AVDISCARD_DEFAULT;
+            LOGI("🧊 Reusing standby video decoder");
+        } else {
+            avcodec_free_context(&codecCtx);
+        }
     }
 
-    if (avcodec_open2(codecCtx, codec, nullptr) < 0) {
-        LOGE("❌ Failed to open codec");
-        return;
+    if (!codecCtx) {
+        codecCtx = avcodec_alloc_context3(codec);
+        if (!codecCtx || avcodec_parameters_to_context(codecCtx, codecpar) < 0) {
+            LOGE("❌ Failed to create codec context");
+            avcodec_free_context(&codecCtx);
+            return;
+        }
+        codecCtx->pkt_timebase = timeBase;
+
+        // 按分辨率、profile 和大小核拓扑选择线程类型和数量
+        applyDecodeThreading(codecCtx, chooseDecodeThreading(codec, codecpar, lowLatency));
+        // 包上的静止帧标记随 opaque_ref 带到解码出的帧上
+        codecCtx->flags |= AV_CODEC_FLAG_COPY_OPAQUE;
+        codecCtx->lowres = lowres;
+        if (codecCtx->lowres > 0) {
+            LOGI("🔽 Decoding at lowres=%d for %dx%d surface", codecCtx->lowres,
+                 surfaceSize->width.load(), surfaceSize->height.load());
+        }
+
+        if (avcodec_open2(codecCtx, codec, nullptr) < 0) {
+            LOGE("❌ Failed to open codec");
+            avcodec_free_context(&codecCtx);
+            return;
+        }
     }
 
+    const CpuTopology& cpu = getCpuTopology();
+    stats->decodeThreadType = codecCtx->active_thread_type;
+    stats->decodeThreadCount = codecCtx->thread_count;
+    stats->cpuBigCores = cpu.bigCores;
+    stats->cpuLittleCores = cpu.littleCores;
+
     LOGI("✅ Decoder initialized");
 
+    // 提示的跳转目标在后台用同样的 lowres 预解码；这里只登记，第一个提示到来时才打开第二个输入
+    speculative->open(path, codecCtx->lowres);
+
     AVPacket* pkt = nullptr;
     AVFrame* frame = av_frame_alloc();
-    struct SwsContext* swsCtx = nullptr;
+    DecodeDegrader degrader; // 追帧降级控制
 
-    int width = codecCtx->width;
-    int height = codecCtx->height;
-    enum AVPixelFormat srcFormat = codecCtx->pix_fmt;
+    // 颜色转换按条带作为任务交给共享调度器，解码线程发起转换后立即回去送下一个包；条带数不超过大核数，
+    // 实际条带数再由 SwsCache 按分辨率决定（1080p 及以下最多 2 条）
+    SliceConverter converter(std::max(1, cpu.bigCores));
+    FramePool framePool;    // 输出帧缓冲区循环复用，稳定播放时不再分配帧内存
+    ConvertKey convertKey;  // 当前转换参数，帧的尺寸/格式/色彩空间或 Surface 尺寸变化时重新从缓存获取
+    AVFrame* pendingSrc = nullptr;  // 正在转换的 YUV 帧引用
+    AVFrame* pendingDst = nullptr;  // 正在写入的 RGBA 帧
 
-    // 初始化 sws 上下文
-    swsCtx = sws_getContext(
-            width, height, srcFormat,
-            width, height, AV_PIX_FMT_RGBA,
-            SWS_BILINEAR, nullptr, nullptr, nullptr
-    );
+    // 跳转状态
+    int serial = control->getSerial();
+    int64_t seekPts = AV_NOPTS_VALUE;   // 精确跳转的目标，之前的帧只进缓存不显示
+    int64_t shownPts = AV_NOPTS_VALUE;  // 缓存命中时已直接显示的帧，重新解码到它为止的帧都跳过
+    AVFrame* heldFrame = nullptr;       // 目标之前的最后一帧，确认它覆盖目标时间后再显示
+    bool scrubbing = false;             // 拖动预览中
+    TrickMode trickMode = TrickMode::None;  // 倍速播放的丢帧策略
+    FrameDecimator decimator;           // 内容帧率高于刷新率时的抽帧
+    StaticFrameDetector staticFrames;   // 与上一次显示相同的帧不转换也不上传
+    int64_t prevPts = AV_NOPTS_VALUE;   // 连续解码中的上一帧，供缓存判断相邻关系
+    bool surfaceAttached = true;        // Surface 分离（后台）时只解关键帧
+    bool capturing = standby && standby->firstGop.empty();  // 收集文件开头的帧留给热备缓存，跳转后停止
 
-    if (!swsCtx) {
-        LOGE("❌ Failed to create SwsContext");
-        return;
+    // 倍速、抽帧和 Surface 分离要求的最低丢帧程度，取其中最激进的
+    auto applySkipFloor = [&]() {
+        AVDiscard trickSkip = trickMode == TrickMode::Keyframes || !surfaceAttached ? AVDISCARD_NONKEY :
+                              trickMode == TrickMode::NonRef ? AVDISCARD_NONREF : AVDISCARD_DEFAULT;
+        degrader.setSkipFloor(codecCtx, std::max(trickSkip, decimator.skipFrame()));
+    };
+
+    // 等待上一帧转换结束并送入 frameQueue
+    auto finishPending = [&](bool push) {
+        if (!pendingDst) return;
+        stats->convertTimeUs += converter.wait();
+        stats->sliceCpuUs = converter.getCpuUs();
+        stats->convertedFrames++;
+        av_frame_free(&pendingSrc);
+        if (push) {
+            LOGD("🎨 RGBA frame %p pushed to queue: size=%dx%d  linesize=%d",
+                 pendingDst, pendingDst->width, pendingDst->height, pendingDst->linesize[0]);
+            frameQueue->push(pendingDst);  // ✅ 拷贝后的帧，safe push
+        } else {
+            av_frame_free(&pendingDst);
+        }
+        pendingDst = nullptr;
+    };
+
+    // 内容没变的帧：只送一个不带数据的帧，渲染线程按时更新显示位置，不上传也不重绘
+    // Surface 尺寸等转换参数变了时仍需重新转换，返回 false
+    auto elide = [&](const AVFrame* src) {
+        int dstWidth, dstHeight;
+        fitToSurface(src, surfaceSize, dstWidth, dstHeight);
+        if (ConvertKey::fromFrame(src, dstWidth, dstHeight, outputFormat) != convertKey) return false;
+
+        AVFrame* repeat = av_frame_alloc();
+        if (!repeat) return false;
+        repeat->pts = src->best_effort_timestamp;
+        repeat->opaque = serialTag(serial);
+        finishPending(true);
+        frameQueue->push(repeat);
+
+        int64_t converted = stats->convertedFrames.load();
+        stats->elidedFrames++;
+        stats->elidedBytes += av_image_get_buffer_size(outputFormat, dstWidth, dstHeight, 1);
+        if (converted > 0) stats->elidedConvertUs += stats->convertTimeUs.load() / converted;
+        stats->staticHashUs = staticFrames.getHashUs();
+        return true;
+    };
+
+    // 发起一帧的转换，转换完成后在下一次 finishPending 时送入 frameQueue
+    auto present = [&](const AVFrame* src) {
+        // 上一帧必须先转换完，转换器才能切换到这一帧
+        finishPending(true);
+
+        int dstWidth, dstHeight;
+        fitToSurface(src, surfaceSize, dstWidth, dstHeight);
+        ConvertKey key = ConvertKey::fromFrame(src, dstWidth, dstHeight, outputFormat);
+        if (key != convertKey) {
+            if (!converter.configure(key)) {
+                LOGE("❌ Unsupported frame format %d, skipping...", src->format);
+                convertKey = ConvertKey();
+                return;
+            }
+            convertKey = key;
+            stats->convertKernel = converter.getKernelName();
+            stats->convertSlices = converter.getSliceCount();
+            stats->swsCacheHits = converter.getCache().getHits();
+            stats->swsCacheMisses = converter.getCache().getMisses();
+        }
+
+        // ✅ 从缓冲池取新的 RGBA 帧（每一帧独立）
+        // 行按 64 字节对齐，便于 SIMD 写入和 GL 上传；渲染后 av_frame_free 把缓冲区还给池
+        AVFrame* rgbaFrame = framePool.acquire(dstWidth, dstHeight, outputFormat, 64);
+        if (!rgbaFrame) {
+            LOGE("❌ Failed to allocate RGBA frame! Skipping...");
+            return;
+        }
+        stats->framePoolHits = framePool.getHits();
+        stats->framePoolMisses = framePool.getMisses();
+
+        rgbaFrame->pts = src->best_effort_timestamp;
+        rgbaFrame->pkt_dts = src->pkt_dts;
+        rgbaFrame->repeat_pict = src->repeat_pict;
+        rgbaFrame->opaque = serialTag(serial);
+
+        // ✅ 异步执行转换，src 可能被下一次 receive 复用，所以持有一份引用
+        pendingSrc = av_frame_clone(src);
+        if (!pendingSrc) {
+            av_frame_free(&rgbaFrame);
+            return;
+        }
+        pendingDst = rgbaFrame;
+        converter.start(pendingSrc, pendingDst);
+        stats->sourcePixels += (int64_t) codecpar->width * codecpar->height;
+        stats->convertedPixels += (int64_t) dstWidth * dstHeight;
+    };
+
+    // 新的跳转：冲刷解码器，目标帧在缓存里就立即显示，否则从关键帧解码到目标
+    auto beginSeek = [&](int newSerial, double target) {
+        finishPending(false);
+        av_frame_free(&heldFrame);
+        avcodec_flush_buffers(codecCtx);
+        decimator.reset();
+        staticFrames.invalidate();
+        applySkipFloor();
+        degrader.reset(codecCtx);
+        frameQueue->clear();
+        serial = newSerial;
+        capturing = false;
+        prevPts = AV_NOPTS_VALUE;
+        seekPts = AV_NOPTS_VALUE;
+        shownPts = AV_NOPTS_VALUE;
+
+        // 拖动预览只解码关键帧，并跳过环路滤波；松手后的精确跳转恢复正常（degrader.reset 已恢复）
+        scrubbing = control->isScrubbing();
+        if (scrubbing) {
+            codecCtx->skip_frame = AVDISCARD_NONKEY;
+            codecCtx->skip_loop_filter = AVDISCARD_ALL;
+        }
+
+        // 倒放不走缓存，由 playReverse 从目标帧开始往前解码；拖动和高倍速时直接显示解复用送来的关键帧
+        if (control->getDirection() < 0 || scrubbing || trickMode == TrickMode::Keyframes) return;
+
+        int64_t targetPts = llrint(target / av_q2d(timeBase));
+        AVFrame* cached = frameCache->findCovering(targetPts);
+        stats->frameCacheHits = frameCache->getHits();
+        stats->frameCacheMisses = frameCache->getMisses();
+        if (cached) {
+            LOGI("⚡ Seek %.3f served from frame cache (pts=%lld)", target, (long long) cached->best_effort_timestamp);
+            present(cached);
+            finishPending(true);  // 不等后面的帧，立即送去显示
+            shownPts = cached->best_effort_timestamp;
+            av_frame_free(&cached);
+            return;
+        }
+
+        std::vector<AVFrame*> frames;
+        if (speculative->take(targetPts, frames)) {
+            LOGI("⚡ Seek %.3f served from %zu speculative frames", target, frames.size());
+            for (AVFrame* f : frames) {
+                present(f);
+                finishPending(true);
+            }
+            shownPts = frames.back()->best_effort_timestamp;
+            for (AVFrame* f : frames) av_frame_free(&f);
+        } else {
+            seekPts = targetPts;
+        }
+    };
+
+    // 解码输出的一帧：先进缓存，再按跳转状态决定是否显示
+    auto onFrame = [&](AVFrame* decoded) {
+        // A-B 循环里只为参考而解码的帧（A 之前/B 之后）
+        if (decoded->flags & AV_FRAME_FLAG_DISCARD) return;
+        if (capturing) {
+            standby->captureFirstGop(decoded);
+            capturing = !standby->firstGopDone;
+        }
+
+        int64_t pts = decoded->best_effort_timestamp;
+        frameCache->insert(decoded, prevPts, control->getDisplayedPts());
+        prevPts = pts;
+
+        if (shownPts != AV_NOPTS_VALUE) {
+            if (pts != AV_NOPTS_VALUE && pts <= shownPts) return;
+            shownPts = AV_NOPTS_VALUE;
+        }
+        if (seekPts != AV_NOPTS_VALUE && pts != AV_NOPTS_VALUE) {
+            if (pts < seekPts) {
+                av_frame_free(&heldFrame);
+                heldFrame = av_frame_clone(decoded);
+                return;
+            }
+            if (heldFrame && pts > seekPts) present(heldFrame);
+            av_frame_free(&heldFrame);
+            seekPts = AV_NOPTS_VALUE;
+        } else if (scrubbing) {
+            stats->scrubPreviews++;
+        } else if (pts != AV_NOPTS_VALUE) {
+            // 根据解码进度落后主时钟的程度调整降级级别（跳转中的帧本来就在目标之前，不参与）
+            degrader.update(codecCtx, timer->getCurrentTime() - pts * av_q2d(timeBase));
+
+            // 刷新率跟不上时，转换和上传之前就丢掉显示不出来的帧
+            decimator.observe(pts * av_q2d(timeBase), decoded->pict_type);
+            AVDiscard skip = decimator.skipFrame();
+            bool shown = decimator.keep(surfaceSize->refreshRate.load(), control->getSpeed());
+            if (decimator.skipFrame() != skip) applySkipFloor();
+            if (!shown) {
+                stats->decimatedFrames++;
+                staticFrames.invalidate();
+                return;
+            }
+            if (staticFrames.isUnchanged(decoded, codecCtx->has_b_frames > 0) && elide(decoded)) return;
+        }
+        present(decoded);
+    };
+
+    // 倒放：另一个线程按 GOP 从后往前解码，这里把每一批帧倒序转换送显，直到下一次跳转
+    auto playReverse = [&](double target) {
+        ReverseDecoder reverse(path, codecCtx->lowres, control, timer, stats, serial);
+        if (!reverse.start(llrint(target / av_q2d(timeBase)))) return;
+
+        std::vector<AVFrame*> batch;
+        while (reverse.nextBatch(batch)) {
+            stats->videoDecodeWakeups++;
+            for (auto it = batch.rbegin(); it != batch.rend(); ++it) {
+                if (control->getSerial() != serial) break;
+                present(*it);
+                stats->reverseFrames++;
+            }
+            for (AVFrame* f : batch) av_frame_free(&f);
+            batch.clear();
+        }
+        finishPending(control->getSerial() == serial);
+        LOGI("⏪ Reverse playback stopped");
+    };
+
+    // 热备缓存命中：文件开头的帧已经解码好，直接送显；解复用从头读，重新解码到这些帧为止都跳过
+    if (standby && !capturing) {
+        for (AVFrame* f : standby->firstGop) {
+            frameCache->insert(f, prevPts, AV_NOPTS_VALUE);
+            prevPts = f->best_effort_timestamp;
+            present(f);
+        }
+        finishPending(true);
+        shownPts = prevPts;
+        prevPts = AV_NOPTS_VALUE;
+        stats->standbyFrames = (int64_t) standby->firstGop.size();
+        LOGI("🧊 %zu first-GOP frames served from standby", standby->firstGop.size());
     }
 
-    while (!(packetQueue->isFinished() && packetQueue->empty() )) {
+    while (!control->isStopped()) {
         pkt = packetQueue->pop();
-        if (!pkt) continue;
+        stats->videoDecodeWakeups++;
+        if (!pkt) break;  // 只有停止后才返回空
+
+        // 倍速变化：2x-4x 丢弃非参考帧，更高倍速解复用只送关键帧
+        TrickMode mode = control->getTrickMode();
+        if (mode != trickMode) {
+            trickMode = mode;
+            applySkipFloor();
+            LOGI("⏩ Trick mode %d", (int) mode);
+        }
+
+        // Surface 分离后立即只解关键帧；重新附着后等到关键帧再恢复，之前的包缺参考帧会花屏
+        bool attached = surfaceSize->attached.load();
+        if (attached != surfaceAttached && (!attached || (pkt->flags & AV_PKT_FLAG_KEY))) {
+            surfaceAttached = attached;
+            applySkipFloor();
+            LOGI("🔌 Surface %s, decoding %s", attached ? "attached" : "detached",
+                 attached ? "all frames" : "keyframes only");
+        }
+
+        // 解复用线程跳转后送来的第一个包会唤醒这里
+        int seekSerial;
+        double seekTarget;
+        control->getSeek(seekSerial, seekTarget);
+        if (seekSerial != serial) {
+            beginSeek(seekSerial, seekTarget);
+            if (control->getDirection() < 0 && !scrubbing) {
+                // 解复用线程倒放时不读包，只送来一个空包唤醒这里
+                av_packet_free(&pkt);
+                playReverse(seekTarget);
+                continue;
+            }
+        }
+
+        // 跳转之前读出的包
+        if (serialOf(pkt->opaque) != serial) {
+            av_packet_free(&pkt);
+            continue;
+        }
 
         LOGD("📦 Packet %p send from queue: time=%.3f pts=%lld dts=%lld duration=%lld size=%d",
              pkt,
-             pkt->pts * av_q2d(codecCtx->time_base),
+             pkt->pts * av_q2d(timeBase),
              pkt->pts,
              pkt->dts,
              pkt->duration,
              pkt->size
         );
 
-        int ret = avcodec_send_packet(codecCtx, pkt);
+        bool endOfStream = isEndOfStream(pkt);
+
+        // 严重落后时丢弃非关键帧包，直接追到下一个关键帧
+        if (!endOfStream && degrader.shouldDropPacket(codecCtx, pkt)) {
+            av_packet_free(&pkt);
+            continue;
+        }
+
+        auto sendStart = std::chrono::steady_clock::now();
+        if (!endOfStream) StaticFrameDetector::tagPacket(pkt, codecCtx->codec_id);
+        int ret;
+        {
+            PlayerStats::CpuSpan cpuSpan(stats->decodeCpuUs);
+            ret = avcodec_send_packet(codecCtx, endOfStream ? nullptr : pkt);
+        }
+        stats->decodeTimeUs += elapsedUs(sendStart);
         av_packet_free(&pkt);
 
         if (ret < 0) {
             LOGE("❌ Error sending packet to decoder");
             continue;
         }
+        degrader.onPacketSent();
 
         while (ret >= 0) {
-            if (!Timer::isPlaying){
-                return;
+            if (control->isStopped() || control->getSerial() != serial) break;
+            auto receiveStart = std::chrono::steady_clock::now();
+            {
+                PlayerStats::CpuSpan cpuSpan(stats->decodeCpuUs);
+                ret = avcodec_receive_frame(codecCtx, frame);
             }
-            ret = avcodec_receive_frame(codecCtx, frame);
+            stats->decodeTimeUs += elapsedUs(receiveStart);
             if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) break;
             else if (ret < 0) {
                 LOGE("❌ Error during decoding");
@@ -91,46 +471,33 @@ void decodeThread(PacketQueue* packetQueue, FrameQueue* frameQueue, AVCodecParam
             LOGD("✅ Frame decoded: pts=%lld  size=%dx%d  format=%d",
                  frame->pts, frame->width, frame->height, frame->format);
 
-            // ✅ 创建新的 RGBA 帧（每一帧独立）
-            AVFrame* rgbaFrame = av_frame_alloc();
-            rgbaFrame->format = AV_PIX_FMT_RGBA;
-            rgbaFrame->width = frame->width;
-            rgbaFrame->height = frame->height;
-
-            int numBytes = av_image_get_buffer_size(AV_PIX_FMT_RGBA, frame->width, frame->height, 1);
-            uint8_t* buffer = (uint8_t*)av_malloc(numBytes);
-            av_image_fill_arrays(rgbaFrame->data, rgbaFrame->linesize, buffer, AV_PIX_FMT_RGBA, frame->width, frame->height, 1);
-
-            // ✅ 执行转换
-            sws_scale(swsCtx,
-                      frame->data, frame->linesize,
-                      0, frame->height,
-                      rgbaFrame->data, rgbaFrame->linesize);
-
-            if (rgbaFrame->linesize[0] <= 0 || rgbaFrame->data[0] == nullptr) {
-                LOGE("❌ Invalid RGBA frame! Skipping...");
-                av_frame_free(&rgbaFrame);
-                av_free(buffer);
-                continue;
-            }
-
-            rgbaFrame->pts = frame->pts;
-            rgbaFrame->pts = frame->pts;
-            rgbaFrame->pkt_dts = frame->pkt_dts;
-            rgbaFrame->repeat_pict = frame->repeat_pict;
-
-            LOGD("🎨 RGBA frame %p pushed to queue: size=%dx%d  linesize=%d",
-                 rgbaFrame, rgbaFrame->width, rgbaFrame->height, rgbaFrame->linesize[0]);
+            degrader.onFrameReceived();
+            stats->decodedFrames++;
+            onFrame(frame);
+            av_frame_unref(frame);
+        }
 
-            frameQueue->push(rgbaFrame);  // ✅ 拷贝后的帧，safe push
+        if (endOfStream && control->getSerial() == serial) {
+            // 目标在最后一帧之后：显示最后一帧
+            if (heldFrame) present(heldFrame);
+            av_frame_free(&heldFrame);
+            seekPts = AV_NOPTS_VALUE;
+            finishPending(true);
+            LOGI("🏁 Video decoder reached end of stream");
         }
     }
 
+    finishPending(false);
+    av_frame_free(&heldFrame);
+    speculative->close();
+
     LOGI("🛑 Decoder thread finished");
+    degrader.logStats();
 
     // 清理资源
-    sws_freeContext(swsCtx);
     av_frame_free(&frame);
+    // 解码器交还给热备条目，由 NativePlayer 决定留下还是释放
+    if (standby) std::swap(codecCtx, standby->videoCodecCtx);
     avcodec_free_context(&codecCtx);
     frameQueue->setFinished(true);
 }
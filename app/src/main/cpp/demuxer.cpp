@@ -2,40 +2,296 @@
 #include "log.h"
 #define TAG "demuxer"
 #include "packetQueue.h"
+#include "playbackControl.h"
+#include "abLoop.h"
+#include "playerStats.h"
+#include "taskScheduler.h"
 
 extern "C" {
 #include <libavformat/avformat.h>
 #include <libavcodec/avcodec.h>
 }
 
-#include <thread>
+#include <algorithm>
+#include <memory>
 #include "timer.h"
 
-void demuxThread(const char* inputPath, PacketQueue* videoQueue, PacketQueue *audioQueue, int videoStreamIndex, int audioStreamIndex) {
-    AVFormatContext *formatCtx = nullptr;
+// 文件结束标记：没有数据的空包，解码线程收到后排空解码器
+static void pushEndOfStream(PacketQueue* queue, int serial) {
+    AVPacket *eos = av_packet_alloc();
+    eos->opaque = serialTag(serial);
+    queue->push(eos);
+}
+
+// 循环播放时解复用可以无限地往前读，队列里保留这么多视频包后就等待消费
+static const size_t loopQueueAhead = 64;
+// 正常播放时两个队列都超过这些包数就停止读取；暂停时解复用停在这里，直到解码重新消费
+static const size_t videoQueueAhead = 64;
+static const size_t audioQueueAhead = 64;
+// 每一步最多读这么多个包，然后让出工作线程
+static const int packetsPerStep = 16;
 
-    LOGI("📂 Opening input: %s", inputPath);
-    if (avformat_open_input(&formatCtx, inputPath, nullptr, nullptr) != 0) {
-        LOGE("❌ Failed to open input: %s", inputPath);
+// 高倍速只送关键帧时，队列里最多留这么多包，下一个关键帧按送出时的主时钟挑选
+static const size_t trickQueueAhead = 1;
+// 关键帧要领先主时钟这么多秒（实际时间）才来得及解码和转换，媒体时间上再乘以倍速
+static const double trickLeadSeconds = 0.15;
+
+// 定位到离 target 最近的关键帧（前后都可以），把它送入视频队列
+static void pushScrubKeyframe(AVFormatContext* formatCtx, AVPacket* packet, PacketQueue* videoQueue, int videoStreamIndex,
+                              double target, int serial, PlaybackControl* control) {
+    int64_t ts = (int64_t) (target * AV_TIME_BASE);
+    if (avformat_seek_file(formatCtx, -1, INT64_MIN, ts, INT64_MAX, 0) < 0) {
+        LOGE("❌ Scrub seek to %.3f failed", target);
         return;
     }
+    while (control->getSerial() == serial && av_read_frame(formatCtx, packet) >= 0) {
+        bool key = packet->stream_index == videoStreamIndex && (packet->flags & AV_PKT_FLAG_KEY);
+        if (key) {
+            AVPacket *keyPacket = av_packet_clone(packet);
+            keyPacket->opaque = serialTag(serial);
+            videoQueue->push(keyPacket);
+        }
+        av_packet_unref(packet);
+        if (key) return;
+    }
+}
 
-    LOGI("🔍 Finding stream info...");
-    if (avformat_find_stream_info(formatCtx, nullptr) < 0) {
-        LOGE("❌ Failed to find stream info");
-        avformat_close_input(&formatCtx);
-        return;
+// 上一个关键帧离显示还远时先等主时钟，避免一次送出一串关键帧、到显示时已经过时；返回还要等的实际时间（秒）
+static double keyframeDelay(AVFormatContext* formatCtx, int videoStreamIndex, int64_t lastKeyPts,
+                            PlaybackControl* control, Timer* timer) {
+    if (lastKeyPts == AV_NOPTS_VALUE) return 0;
+    AVRational tb = formatCtx->streams[videoStreamIndex]->time_base;
+    double speed = control->getSpeed();
+    return (lastKeyPts * av_q2d(tb) - timer->getCurrentTime()) / speed - trickLeadSeconds;
+}
+
+// 定位到主时钟前方、lastKeyPts 之后的第一个关键帧，把它送入视频队列；没有更多关键帧时返回 false
+static bool pushNextKeyframe(AVFormatContext* formatCtx, AVPacket* packet, PacketQueue* videoQueue, int videoStreamIndex,
+                             int64_t& lastKeyPts, int serial, PlaybackControl* control, Timer* timer,
+                             PlayerStats* stats) {
+    AVRational tb = formatCtx->streams[videoStreamIndex]->time_base;
+    double lead = trickLeadSeconds * control->getSpeed();
+    int64_t ts = llrint((timer->getCurrentTime() + lead) / av_q2d(tb));
+    if (lastKeyPts != AV_NOPTS_VALUE) ts = std::max(ts, lastKeyPts + 1);
+    if (avformat_seek_file(formatCtx, videoStreamIndex, ts, ts, INT64_MAX, 0) < 0) {
+        return false;
+    }
+
+    // 不支持精确定位的格式可能落在 ts 之前，顺序读到下一个关键帧
+    while (control->getSerial() == serial && av_read_frame(formatCtx, packet) >= 0) {
+        bool key = packet->stream_index == videoStreamIndex && (packet->flags & AV_PKT_FLAG_KEY) &&
+                   packet->pts != AV_NOPTS_VALUE && (lastKeyPts == AV_NOPTS_VALUE || packet->pts > lastKeyPts);
+        if (key) {
+            lastKeyPts = packet->pts;
+            AVPacket *keyPacket = av_packet_clone(packet);
+            keyPacket->opaque = serialTag(serial);
+            videoQueue->push(keyPacket);
+            stats->trickKeyframes++;
+        }
+        av_packet_unref(packet);
+        if (key) return true;
+    }
+    return control->getSerial() != serial;
+}
+
+
+// 解复用任务：每一步读若干个包；等队列空间、等跳转、等主时钟时交还工作线程，由队列出队、跳转、暂停/恢复或定时唤醒
+class DemuxTask : public Task {
+public:
+    DemuxTask(AVFormatContext* formatCtx, PacketQueue* videoQueue, PacketQueue* audioQueue, int videoStreamIndex,
+              int audioStreamIndex, PlaybackControl* control, Timer* timer, PlayerStats* stats)
+            : formatCtx(formatCtx), videoQueue(videoQueue), audioQueue(audioQueue), videoStreamIndex(videoStreamIndex),
+              audioStreamIndex(audioStreamIndex), control(control), timer(timer), stats(stats) {}
+
+    ~DemuxTask() override {
+        close();
+    }
+
+    Status step() override {
+        PlayerStats::CpuSpan cpuSpan(stats->taskCpuUs);
+        stats->demuxWakeups++;
+        if (control->isStopped()) return finish();
+        if (!packet) open();
+
+        for (int i = 0; i < packetsPerStep; i++) {
+            Status status = readNext();
+            if (status == Status::Done) return finish();
+            if (status == Status::Blocked) return status;
+        }
+        return Status::Yield;
+    }
+
+private:
+    // formatCtx 由 NativePlayer 打开和探测（可能来自热备缓存），这里只读包，不关闭它
+    void open() {
+        packet = av_packet_alloc();
+        serial = control->getSerial();
+        loop.reset(new AbLoop(formatCtx, videoStreamIndex, audioStreamIndex, stats));
+    }
+
+    void close() {
+        loop.reset();
+        av_packet_free(&packet);
+    }
+
+    Status finish() {
+        LOGI("🛑 Demuxer stopped. Cleaning up.");
+        close();
+        LOGI("✅ Demuxing task finished");
+        return Status::Done;
     }
 
-    AVPacket *packet = av_packet_alloc();
+    // 按流送入对应队列，跳转后丢弃
+    bool pushPacket(AVPacket* pkt) {
+        if (control->getSerial() != serial) {
+            av_packet_free(&pkt);
+            return false;
+        }
+        if (pkt->stream_index == videoStreamIndex && videoDiscarded) {
+            av_packet_free(&pkt);  // 纯音频时重放缓存也不送视频
+            return true;
+        }
+        pkt->opaque = serialTag(serial);
+        (pkt->stream_index == videoStreamIndex ? videoQueue : audioQueue)->push(pkt);
+        return true;
+    }
+
+    // 文件结束后不退出，等待下一次跳转
+    Status reachEnd() {
+        LOGI("🛑 Reached end of file (serial=%d)", serial);
+        pushEndOfStream(videoQueue, serial);
+        pushEndOfStream(audioQueue, serial);
+        return waitForSeek();
+    }
+
+    Status waitForSeek() {
+        waitingForSeek = true;
+        return Status::Blocked;
+    }
+
+    // 视频队列出队时会唤醒这里
+    bool hasRoom(size_t ahead) const {
+        return videoQueue->size() <= ahead;
+    }
+
+    // 音频解码在环形缓冲区满时停下，音频队列随之积累；两个队列都到水位才等待，纯音频时只看音频队列
+    bool hasBufferRoom() const {
+        if (videoDiscarded) return audioQueue->size() <= audioQueueAhead;
+        return videoQueue->size() <= videoQueueAhead || audioQueue->size() <= audioQueueAhead;
+    }
+
+    // 进出纯音频：视频流在解复用层丢弃，FFmpeg 不再把它交出来。恢复视频要等 NativePlayer 随后发起的跳转，
+    // 从当前读到的位置直接送视频包会缺参考帧
+    void applyAudioOnly(bool seeking) {
+        bool audioOnly = control->isAudioOnly();
+        if (audioOnly == videoDiscarded || (!audioOnly && !seeking)) return;
+        videoDiscarded = audioOnly;
+        formatCtx->streams[videoStreamIndex]->discard = audioOnly ? AVDISCARD_ALL : AVDISCARD_DEFAULT;
+        loop->setVideoDiscarded(audioOnly);
+        if (audioOnly) videoQueue->clear();
+        LOGI("🎧 Video stream %s", audioOnly ? "discarded (audio only)" : "restored");
+    }
+
+    Status readNext() {
+        applyAudioOnly(false);
+        int seekSerial;
+        double seekTarget;
+        control->getSeek(seekSerial, seekTarget);
+        if (seekSerial != serial) {
+            serial = seekSerial;
+            waitingForSeek = false;
+            applyAudioOnly(true);
+            if (control->isScrubbing()) {
+                // 拖动中：只送离目标最近的一个关键帧和结束标记，解码线程排空后立即显示，然后等下一个目标
+                videoQueue->clear();
+                audioQueue->clear();
+                if (!videoDiscarded) {
+                    pushScrubKeyframe(formatCtx, packet, videoQueue, videoStreamIndex, seekTarget, serial, control);
+                }
+                pushEndOfStream(videoQueue, serial);
+                pushEndOfStream(audioQueue, serial);
+                loop->reset(false, 0, 0, 0);
+                return waitForSeek();
+            }
+
+            if (control->getDirection() < 0) {
+                // 倒放由解码线程自己按 GOP 读文件，这里只送空包唤醒解码线程，然后等下一次跳转
+                videoQueue->clear();
+                audioQueue->clear();
+                pushEndOfStream(videoQueue, serial);
+                pushEndOfStream(audioQueue, serial);
+                return waitForSeek();
+            }
 
-    while (av_read_frame(formatCtx, packet) >= 0) {
-        if (!Timer::isPlaying){
-            return;
+            // 跳到目标之前最近的关键帧，解码线程再从这里解码到目标
+            int64_t ts = (int64_t) (seekTarget * AV_TIME_BASE);
+            if (avformat_seek_file(formatCtx, -1, INT64_MIN, ts, ts, 0) < 0) {
+                LOGE("❌ Seek to %.3f failed", seekTarget);
+            } else {
+                LOGI("🎯 Demuxer seeked to %.3f (serial=%d)", seekTarget, serial);
+            }
+            videoQueue->clear();
+            audioQueue->clear();
+
+            double loopStart, loopEnd;
+            bool looping = control->getLoop(loopStart, loopEnd);
+            loop->reset(looping, loopStart, loopEnd, seekTarget);
+            lastKeyPts = AV_NOPTS_VALUE;
+            // 高倍速不再送音频包，用结束标记让音频解码清空缓冲区
+            if (control->getTrickMode() == TrickMode::Keyframes) pushEndOfStream(audioQueue, serial);
+        }
+        if (waitingForSeek) return Status::Blocked;
+
+        // 高倍速：逐个关键帧定位读取，音频和非关键帧都不读（A-B 循环仍按原方式读，由解码器跳过非关键帧）
+        if (control->getTrickMode() == TrickMode::Keyframes && !loop->isActive() && !videoDiscarded) {
+            // 暂停时主时钟不走，不用定时醒来，恢复时会被唤醒
+            if (!hasRoom(trickQueueAhead) || control->isPaused()) return Status::Blocked;
+            double delay = keyframeDelay(formatCtx, videoStreamIndex, lastKeyPts, control, timer);
+            if (delay > 0) {
+                wakeAfter(delay);
+                return Status::Blocked;
+            }
+            if (pushNextKeyframe(formatCtx, packet, videoQueue, videoStreamIndex, lastKeyPts, serial, control, timer, stats)) {
+                return Status::Yield;
+            }
+            return reachEnd();
+        }
+
+        // 循环区间已缓存：不再读文件，直接重放
+        if (loop->isCached()) {
+            if (!hasRoom(loopQueueAhead)) return Status::Blocked;
+            if (!loop->replay([this](AVPacket* pkt) { return pushPacket(pkt); })) {
+                loop->reset(false, 0, 0, 0);
+            }
+            return Status::Yield;
+        }
+
+        if (loop->isActive() && loop->passFinished()) {
+            if (!hasRoom(loopQueueAhead)) return Status::Blocked;
+            if (loop->wrap()) return Status::Yield;
+            loop->reset(false, 0, 0, 0);
         }
+
+        if (!loop->isActive() && !hasBufferRoom()) return Status::Blocked;
+
+        if (av_read_frame(formatCtx, packet) < 0) {
+            if (loop->isActive()) {
+                // B 在文件末尾之后：读到结尾就回绕
+                if (loop->wrap()) return Status::Yield;
+                loop->reset(false, 0, 0, 0);
+            }
+            return reachEnd();
+        }
+
+        if (loop->isActive() && !loop->filter(packet)) {
+            av_packet_unref(packet);
+            return Status::Yield;
+        }
+
         if (packet->stream_index == videoStreamIndex) {
             AVPacket *new_packet = av_packet_alloc();
             av_packet_ref(new_packet, packet);
+            new_packet->opaque = serialTag(serial);
             LOGD("📦 Video Packet %p added to queue: time=%.3f pts=%lld dts=%lld duration=%lld size=%d",
                  new_packet,
                  packet->pts * av_q2d(formatCtx->streams[videoStreamIndex]->time_base),
@@ -48,6 +304,7 @@ void demuxThread(const char* inputPath, PacketQueue* videoQueue, PacketQueue *au
         } else if (packet->stream_index == audioStreamIndex){
             AVPacket *new_packet = av_packet_alloc();
             av_packet_ref(new_packet, packet);
+            new_packet->opaque = serialTag(serial);
             LOGD("📦 Audio Packet %p added to queue: time=%.3f pts=%lld dts=%lld duration=%lld size=%d",
                  new_packet,
                  packet->pts * av_q2d(formatCtx->streams[audioStreamIndex]->time_base),
@@ -59,13 +316,29 @@ void demuxThread(const char* inputPath, PacketQueue* videoQueue, PacketQueue *au
             audioQueue->push(new_packet);
         }
         av_packet_unref(packet);
+        return Status::Yield;
     }
 
-    LOGI("🛑 Reached end of file. Cleaning up.");
-    av_packet_free(&packet);
-    avformat_close_input(&formatCtx);
-    videoQueue->setFinished(true);
-    audioQueue->setFinished(true);
+    AVFormatContext* formatCtx;
+    PacketQueue* videoQueue;
+    PacketQueue* audioQueue;
+    int videoStreamIndex;
+    int audioStreamIndex;
+    PlaybackControl* control;
+    Timer* timer;
+    PlayerStats* stats;
+
+    AVPacket* packet = nullptr;
+    std::unique_ptr<AbLoop> loop;
+    int serial = 0;
+    int64_t lastKeyPts = AV_NOPTS_VALUE;  // 高倍速时上一个送出的关键帧
+    bool waitingForSeek = false;          // 已到文件末尾或只送了预览帧
+    bool videoDiscarded = false;          // 纯音频模式
+};
 
-    LOGI("✅ Demuxing thread finished");
+std::shared_ptr<Task> createDemuxTask(AVFormatContext* formatCtx, PacketQueue* videoQueue, PacketQueue* audioQueue,
+                                      int videoStreamIndex, int audioStreamIndex, PlaybackControl* control,
+                                      Timer* timer, PlayerStats* stats) {
+    return std::make_shared<DemuxTask>(formatCtx, videoQueue, audioQueue, videoStreamIndex, audioStreamIndex,
+                                       control, timer, stats);
 }
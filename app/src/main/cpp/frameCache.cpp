@@ -0,0 +1,115 @@
+//
+// frameCache.cpp
+//
+
+#include "frameCache.h"
+
+extern "C" {
+#include <libavutil/avutil.h>
+}
+
+#include <iterator>
+
+FrameCache::FrameCache(size_t maxBytes) : maxBytes(maxBytes) {}
+
+FrameCache::~FrameCache() {
+    clear();
+}
+
+size_t FrameCache::frameBytes(const AVFrame* frame) {
+    size_t total = 0;
+    for (AVBufferRef* buf : frame->buf) {
+        if (buf) total += buf->size;
+    }
+    return total;
+}
+
+void FrameCache::insert(const AVFrame* frame, int64_t prevPts, int64_t playheadPts) {
+    int64_t pts = frame->best_effort_timestamp;
+    if (pts == AV_NOPTS_VALUE || maxBytes == 0) return;
+
+    AVFrame* ref = av_frame_clone(frame);
+    if (!ref) return;
+
+    std::lock_guard<std::mutex> lock(mtx);
+    auto it = entries.find(pts);
+    if (it != entries.end()) {
+        // 重新解码到同一帧：换成新引用，保留已知的前驱
+        bytes -= it->second.bytes;
+        av_frame_free(&it->second.frame);
+        if (prevPts == AV_NOPTS_VALUE) prevPts = it->second.prevPts;
+        entries.erase(it);
+    }
+    size_t size = frameBytes(ref);
+    entries.emplace(pts, Entry{ref, prevPts, size});
+    bytes += size;
+    evict(playheadPts);
+}
+
+void FrameCache::evict(int64_t playheadPts) {
+    while (bytes > maxBytes && entries.size() > 1) {
+        // 两端中离播放位置更远的一端先淘汰；还没有播放位置时淘汰最早的帧
+        auto first = entries.begin();
+        auto last = std::prev(entries.end());
+        auto victim = first;
+        if (playheadPts != AV_NOPTS_VALUE &&
+            last->first - playheadPts > playheadPts - first->first) {
+            victim = last;
+        }
+        bytes -= victim->second.bytes;
+        av_frame_free(&victim->second.frame);
+        entries.erase(victim);
+    }
+}
+
+AVFrame* FrameCache::findCovering(int64_t pts) {
+    std::lock_guard<std::mutex> lock(mtx);
+    auto next = entries.upper_bound(pts);
+    if (next == entries.begin() || next == entries.end()) {
+        misses++;
+        return nullptr;
+    }
+    auto covering = std::prev(next);
+    if (next->second.prevPts != covering->first) {
+        misses++;
+        return nullptr;
+    }
+    hits++;
+    return av_frame_clone(covering->second.frame);
+}
+
+int64_t FrameCache::findPrev(int64_t pts) const {
+    std::lock_guard<std::mutex> lock(mtx);
+    auto it = entries.find(pts);
+    if (it == entries.end() || entries.find(it->second.prevPts) == entries.end()) return AV_NOPTS_VALUE;
+    return it->second.prevPts;
+}
+
+int64_t FrameCache::findNext(int64_t pts) const {
+    std::lock_guard<std::mutex> lock(mtx);
+    auto next = entries.upper_bound(pts);
+    if (next == entries.end() || next->second.prevPts != pts) return AV_NOPTS_VALUE;
+    return next->first;
+}
+
+void FrameCache::clear() {
+    std::lock_guard<std::mutex> lock(mtx);
+    for (auto& entry : entries) {
+        av_frame_free(&entry.second.frame);
+    }
+    entries.clear();
+    bytes = 0;
+}
+
+int64_t FrameCache::getHits() const {
+    return hits.load();
+}
+
+int64_t FrameCache::getMisses() const {
+    return misses.load();
+}
+
+size_t FrameCache::getBytes() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return bytes;
+}
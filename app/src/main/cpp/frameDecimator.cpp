@@ -0,0 +1,70 @@
+//
+// frameDecimator.cpp
+//
+
+#include "frameDecimator.h"
+#include "log.h"
+#define TAG "frameDecimator"
+
+#include <cmath>
+
+// 内容帧率超过刷新率这么多倍才抽取，避免 59.94/60 这类时间戳抖动误丢帧
+static const double minRatio = 1.05;
+// 每两帧显示一帧时才跳过非参考帧，只丢非参考帧正好是隔一帧丢一帧
+static const double nonRefRatio = 1.9;
+// 连续这么多帧 B/非 B 严格交替才认为 GOP 结构允许跳过非参考帧
+static const int minAlternating = 30;
+
+void FrameDecimator::reset() {
+    lastTime = -1.0;
+    interval = 0.0;
+    alternating = 0;
+    prevB = false;
+    phase = 1.0;
+    skipNonRef = false;
+}
+
+void FrameDecimator::observe(double time, enum AVPictureType pictType) {
+    // 跳过非参考帧后看到的间隔翻倍，保持之前的估计
+    if (skipNonRef) return;
+
+    double delta = time - lastTime;
+    if (lastTime >= 0 && delta > 0 && delta < 1.0) {
+        interval = interval > 0 ? interval * 0.9 + delta * 0.1 : delta;
+    }
+    lastTime = time;
+
+    // 没有 B 帧金字塔时 B 帧都是非参考帧
+    bool isB = pictType == AV_PICTURE_TYPE_B;
+    alternating = isB != prevB ? alternating + 1 : 0;
+    prevB = isB;
+}
+
+bool FrameDecimator::keep(double refreshRate, double speed) {
+    if (refreshRate <= 0 || interval <= 0) return true;
+
+    double ratio = std::fabs(speed) / (interval * refreshRate);
+    bool nonRef = ratio >= nonRefRatio && (skipNonRef || alternating >= minAlternating);
+    if (nonRef != skipNonRef) {
+        LOGI("🎞️ %s non-reference frames (%.1f fps on %.1f Hz)", nonRef ? "Skipping" : "Decoding",
+             1.0 / interval, refreshRate);
+        skipNonRef = nonRef;
+        if (!nonRef) alternating = 0;
+    }
+    // 解码器已经丢掉一半
+    if (skipNonRef) ratio /= 2;
+
+    if (ratio <= minRatio) {
+        phase = 1.0;
+        return true;
+    }
+    // 按帧计数而不是按时间戳抽取，时间戳抖动不影响节奏
+    bool shown = phase >= 1.0 - 1e-6;
+    if (shown) phase -= 1.0;
+    phase += 1.0 / ratio;
+    return shown;
+}
+
+AVDiscard FrameDecimator::skipFrame() const {
+    return skipNonRef ? AVDISCARD_NONREF : AVDISCARD_DEFAULT;
+}
@@ -0,0 +1,74 @@
+//
+// framePool.cpp
+//
+
+#include "framePool.h"
+#include "log.h"
+#define TAG "framePool"
+
+extern "C" {
+#include <libavutil/imgutils.h>
+#include <libavutil/pixdesc.h>
+}
+
+#include <algorithm>
+
+FramePool::FramePool(size_t max) : maxPools(std::max<size_t>(1, max)) {}
+
+FramePool::~FramePool() {
+    // 还在队列或渲染中的帧持有缓冲区，池会在它们全部归还后才真正释放
+    for (Entry& entry : entries) {
+        av_buffer_pool_uninit(&entry.pool);
+    }
+}
+
+AVBufferRef* FramePool::allocBuffer(void* opaque, size_t size) {
+    FramePool* self = static_cast<FramePool*>(opaque);
+    self->misses++;
+    return av_buffer_alloc(size);
+}
+
+AVFrame* FramePool::acquire(int width, int height, AVPixelFormat format, int align) {
+    int size = av_image_get_buffer_size(format, width, height, align);
+    if (size <= 0) return nullptr;
+
+    auto it = std::find_if(entries.begin(), entries.end(), [&](const Entry& e) {
+        return e.width == width && e.height == height && e.format == format && e.align == align;
+    });
+    if (it != entries.end()) {
+        entries.splice(entries.begin(), entries, it);
+    } else {
+        AVBufferPool* pool = av_buffer_pool_init2(size, this, allocBuffer, nullptr);
+        if (!pool) return nullptr;
+        entries.push_front({width, height, format, align, pool});
+        LOGI("🗃️ New frame pool %dx%d %s (%d bytes/frame)", width, height, av_get_pix_fmt_name(format), size);
+        if (entries.size() > maxPools) {
+            av_buffer_pool_uninit(&entries.back().pool);
+            entries.pop_back();
+        }
+    }
+
+    requests++;
+    AVBufferRef* buf = av_buffer_pool_get(entries.front().pool);
+    if (!buf) return nullptr;
+
+    AVFrame* frame = av_frame_alloc();
+    if (!frame) {
+        av_buffer_unref(&buf);
+        return nullptr;
+    }
+    frame->format = format;
+    frame->width = width;
+    frame->height = height;
+    frame->buf[0] = buf;
+    av_image_fill_arrays(frame->data, frame->linesize, buf->data, format, width, height, align);
+    return frame;
+}
+
+int64_t FramePool::getHits() const {
+    return requests - misses;
+}
+
+int64_t FramePool::getMisses() const {
+    return misses;
+}
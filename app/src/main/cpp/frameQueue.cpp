@@ -5,26 +5,44 @@
 
 #include "frameQueue.h"
 
-FrameQueue::FrameQueue() {}
+FrameQueue::FrameQueue(size_t maxFrames, size_t maxBytes) : maxFrames(maxFrames), maxBytes(maxBytes) {}
 
 FrameQueue::~FrameQueue() {
     clear();
 }
 
+size_t FrameQueue::frameBytes(const AVFrame *frame) {
+    size_t total = 0;
+    for (AVBufferRef *buf : frame->buf) {
+        if (buf) total += buf->size;
+    }
+    return total;
+}
+
+bool FrameQueue::full() const {
+    if (maxFrames > 0 && queue.size() >= maxFrames) return true;
+    return maxBytes > 0 && !queue.empty() && bytes >= maxBytes;
+}
+
 void FrameQueue::push(AVFrame *frame) {
     std::unique_lock<std::mutex> lock(mtx);
+    notFull.wait(lock, [this] { return !full() || finished; });
     queue.push(frame);
+    bytes += frameBytes(frame);
     cv.notify_one();
 }
 
 AVFrame* FrameQueue::pop() {
     std::unique_lock<std::mutex> lock(mtx);
-    cv.wait(lock, [this] { return !queue.empty() || finished; });
+    cv.wait(lock, [this] { return !queue.empty() || finished || interrupted; });
+    interrupted = false;
 
     if (queue.empty()) return nullptr;
 
     AVFrame *frame = queue.front();
     queue.pop();
+    bytes -= frameBytes(frame);
+    notFull.notify_one();
     return frame;
 }
 
@@ -35,12 +53,21 @@ void FrameQueue::clear() {
         av_frame_free(&frame);
         queue.pop();
     }
+    bytes = 0;
+    notFull.notify_all();
+}
+
+void FrameQueue::interrupt() {
+    std::unique_lock<std::mutex> lock(mtx);
+    interrupted = true;
+    cv.notify_all();
 }
 
 void FrameQueue::setFinished(bool isFinished) {
     std::unique_lock<std::mutex> lock(mtx);
     finished = isFinished;
     cv.notify_all();
+    notFull.notify_all();
 }
 
 bool FrameQueue::isFinished() const {
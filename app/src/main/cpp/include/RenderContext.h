@@ -15,6 +15,7 @@ struct RenderContext {
     EGLDisplay display = EGL_NO_DISPLAY;
     EGLSurface surface = EGL_NO_SURFACE;
     EGLContext context = EGL_NO_CONTEXT;
+    EGLConfig config = nullptr;  // 换 Surface 时用同一个配置创建新的 EGLSurface
 
     GLuint program = 0;
     GLuint texture = 0;
@@ -23,6 +24,7 @@ struct RenderContext {
     GLint positionLoc = -1;
     GLint texCoordLoc = -1;
     GLint samplerLoc = -1;
+    GLint texScaleLoc = -1;
 
     int width = 0;
     int height = 0;
@@ -0,0 +1,85 @@
+//
+// abLoop.h
+// A-B 循环：第一遍从文件读出区间内的压缩包并缓存，之后每一遍从内存重放；
+// 时间戳按遍数整体后移，解码和渲染看到的是一条连续的时间线，回绕时不需要冲刷。
+// 音频按包读取，每一遍的第一个音频包带上 LoopMark，音频解码按采样数把输出裁到 [A, B)
+//
+
+#ifndef ANDROIDPLAYER_ABLOOP_H
+#define ANDROIDPLAYER_ABLOOP_H
+
+extern "C" {
+#include "libavformat/avformat.h"
+}
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include "playerStats.h"
+
+// 放在每一遍第一个音频包的 opaque_ref 里，时间已加上这一遍的偏移（秒）
+struct LoopMark {
+    double start;  // 这一遍从这里开始输出
+    double end;    // 输出到这里为止（B）
+};
+
+class AbLoop {
+public:
+    AbLoop(AVFormatContext* formatCtx, int videoStreamIndex, int audioStreamIndex, PlayerStats* stats);
+    ~AbLoop();
+
+    // 每次跳转后调用；target 为这次跳转的目标，等于 start 时这一遍就可以直接缓存
+    void reset(bool enabled, double start, double end, double target);
+    bool isActive() const;
+    bool isCached() const;
+
+    // 处理从文件读出的包：区间外的丢弃（返回 false），A 之前/B 之后仍需解码的视频包标记 DISCARD，
+    // 跨过 A 或 B 的音频包保留（由音频解码裁剪），需要时存入缓存，最后加上当前这一遍的时间偏移
+    bool filter(AVPacket* pkt);
+
+    // 视频和音频都已读到 B
+    bool passFinished() const;
+
+    // 纯音频模式下读不到视频包，这一遍只看音频是否到 B
+    void setVideoDiscarded(bool discarded);
+
+    // 开始下一遍：缓存完整时之后用 replay，否则把文件定位到 A 之前的关键帧重新读；
+    // 上一遍一个包都没有（区间在文件之外）时返回 false
+    bool wrap();
+
+    // 把缓存的包加上这一遍的偏移依次交给 push，push 返回 false 时中断
+    bool replay(const std::function<bool(AVPacket*)>& push);
+
+private:
+    int64_t offsetFor(int streamIndex) const;
+    void applyOffset(AVPacket* pkt) const;
+    void markPassStart(AVPacket* pkt);
+    void freeCache();
+
+    AVFormatContext* formatCtx;
+    int videoStreamIndex;
+    int audioStreamIndex;
+    PlayerStats* stats;
+
+    bool active = false;
+    double start = 0.0;
+    double end = 0.0;
+    int64_t videoStart = 0, videoEnd = 0;  // 视频流时间基
+    int64_t audioStart = 0, audioEnd = 0;  // 音频流时间基
+
+    int iteration = 0;          // 已回绕的次数，决定时间偏移
+    bool videoDone = false;
+    bool videoDiscarded = false;
+    bool audioDone = false;
+    int passPackets = 0;        // 这一遍送出的包数
+    double passStart = 0.0;     // 这一遍音频的起点（未加偏移）：A，或第一遍从区间中间开始时的跳转目标
+    bool markPending = false;   // 这一遍还没有送出音频包
+    bool caching = false;       // 这一遍从 A 开始读，正在缓存
+    bool cached = false;        // 缓存已完整
+    bool overflowed = false;    // 区间太长放不进缓存，每一遍都从文件读
+    std::vector<AVPacket*> cache;
+    size_t cacheBytes = 0;
+};
+
+
+#endif //ANDROIDPLAYER_ABLOOP_H
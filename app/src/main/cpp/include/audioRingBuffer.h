@@ -9,6 +9,7 @@
 
 #include <mutex>
 #include <condition_variable>
+#include <functional>
 
 class AudioRingBuffer {
 public:
@@ -22,6 +23,10 @@ public:
     void setFinished(bool val);
     bool isFinished();
     bool isEmpty();
+    size_t buffered();
+
+    // read 把缓冲量降到 bytes 及以下时在锁外调用 listener，音频解码据此从水位恢复；在开始读写前设置
+    void setLowWaterListener(size_t bytes, std::function<void()> listener);
 
 private:
     uint8_t* buffer;
@@ -33,6 +38,8 @@ private:
     std::mutex mutex;
     std::condition_variable cond;
     bool finished = false;
+    size_t lowWater = 0;
+    std::function<void()> onLowWater;
 };
 
 
@@ -0,0 +1,31 @@
+//
+// cancelToken.h
+// 协作式取消：stop 时置位，各线程的循环检查它；FFmpeg 的读取和打开通过 interrupt_callback 检查它。
+// 阻塞等待的唤醒由 PlaybackControl 的 listener 负责
+//
+
+#ifndef ANDROIDPLAYER_CANCELTOKEN_H
+#define ANDROIDPLAYER_CANCELTOKEN_H
+
+extern "C" {
+#include "libavformat/avio.h"
+}
+
+#include <atomic>
+
+class CancelToken {
+public:
+    // 下一次播放开始前调用
+    void reset();
+    void cancel();
+    bool isCancelled() const;
+
+    // 设置到 AVFormatContext::interrupt_callback，取消后阻塞的 av_read_frame 等返回 AVERROR_EXIT
+    AVIOInterruptCB interruptCallback() const;
+
+private:
+    std::atomic<bool> cancelled{false};
+};
+
+
+#endif //ANDROIDPLAYER_CANCELTOKEN_H
@@ -0,0 +1,65 @@
+//
+// decodeDegrader.h
+// 解码追帧降级控制：根据解码进度落后主时钟的程度逐级降低解码质量
+//
+
+#ifndef ANDROIDPLAYER_DECODEDEGRADER_H
+#define ANDROIDPLAYER_DECODEDEGRADER_H
+
+extern "C" {
+#include "libavcodec/avcodec.h"
+}
+
+#include <chrono>
+#include <cstdint>
+
+class DecodeDegrader {
+public:
+    enum Level {
+        LEVEL_NONE = 0,          // 正常解码
+        LEVEL_SKIP_LOOP_FILTER,  // 跳过环路滤波
+        LEVEL_SKIP_NONREF,       // 丢弃非参考帧
+        LEVEL_SKIP_TO_KEYFRAME,  // 丢包直到下一个关键帧
+        LEVEL_COUNT
+    };
+
+    DecodeDegrader();
+
+    // lag: 解码进度落后主时钟的秒数（> 0 表示落后）
+    void update(AVCodecContext* codecCtx, double lag);
+
+    // 跳转后解码进度和主时钟重新对齐，回到正常解码
+    void reset(AVCodecContext* codecCtx);
+
+    // 倍速播放要求的最低丢帧程度，降级级别只会在此之上叠加
+    void setSkipFloor(AVCodecContext* codecCtx, AVDiscard skipFrame);
+
+    // 送入解码器前调用，返回 true 表示该包应被丢弃
+    bool shouldDropPacket(AVCodecContext* codecCtx, const AVPacket* pkt);
+
+    // 统计送入/输出的帧数，用于估算解码器内部丢弃的非参考帧
+    void onPacketSent();
+    void onFrameReceived();
+
+    Level getLevel() const;
+    void logStats();
+
+private:
+    void setLevel(AVCodecContext* codecCtx, Level newLevel, double lag);
+    void accumulateLevelTime();
+    void applySkip(AVCodecContext* codecCtx) const;
+
+    Level level = LEVEL_NONE;
+    bool waitingKeyframe = false;
+    AVDiscard skipFloor = AVDISCARD_DEFAULT;
+
+    std::chrono::steady_clock::time_point levelSince;
+    double timeAtLevel[LEVEL_COUNT] = {};
+
+    int64_t droppedPackets = 0;   // 等待关键帧时丢弃的包
+    int64_t sentPackets = 0;      // 降级期间送入解码器的包
+    int64_t receivedFrames = 0;   // 降级期间解码输出的帧
+    int64_t discardedFrames = 0;  // 解码器内部丢弃的帧（估算）
+};
+
+#endif //ANDROIDPLAYER_DECODEDEGRADER_H
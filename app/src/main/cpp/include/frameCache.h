@@ -0,0 +1,59 @@
+//
+// frameCache.h
+// 播放位置附近已解码帧（YUV 引用）的缓存，按内存预算淘汰离播放位置最远的帧，用于逐帧步进和短距离回退
+//
+
+#ifndef ANDROIDPLAYER_FRAMECACHE_H
+#define ANDROIDPLAYER_FRAMECACHE_H
+
+extern "C" {
+#include "libavutil/frame.h"
+}
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <mutex>
+
+class FrameCache {
+public:
+    explicit FrameCache(size_t maxBytes);
+    ~FrameCache();
+
+    // 缓存 frame 的一份引用，pts 取 best_effort_timestamp；
+    // prevPts 是同一段连续解码中的上一帧，跳转/冲刷后的第一帧传 AV_NOPTS_VALUE
+    void insert(const AVFrame* frame, int64_t prevPts, int64_t playheadPts);
+
+    // 查找覆盖 pts 的帧（它之后的下一帧也在缓存中且首尾相连，才能确认中间没有漏帧），返回新引用
+    AVFrame* findCovering(int64_t pts);
+
+    // 已知相邻的上一帧/下一帧 pts，不确定时返回 AV_NOPTS_VALUE
+    int64_t findPrev(int64_t pts) const;
+    int64_t findNext(int64_t pts) const;
+
+    void clear();
+
+    int64_t getHits() const;
+    int64_t getMisses() const;
+    size_t getBytes() const;
+
+private:
+    struct Entry {
+        AVFrame* frame;
+        int64_t prevPts;
+        size_t bytes;
+    };
+
+    static size_t frameBytes(const AVFrame* frame);
+    void evict(int64_t playheadPts);
+
+    std::map<int64_t, Entry> entries;
+    mutable std::mutex mtx;
+    size_t maxBytes;
+    size_t bytes = 0;
+    std::atomic<int64_t> hits{0};
+    std::atomic<int64_t> misses{0};
+};
+
+
+#endif //ANDROIDPLAYER_FRAMECACHE_H
@@ -0,0 +1,39 @@
+//
+// frameDecimator.h
+// 帧率抽取：内容帧率高于屏幕刷新率时，转换和上传之前按均匀的节奏丢掉不可能被显示的帧；
+// 参考帧和非参考帧严格交替时，直接让解码器跳过非参考帧
+//
+
+#ifndef ANDROIDPLAYER_FRAMEDECIMATOR_H
+#define ANDROIDPLAYER_FRAMEDECIMATOR_H
+
+extern "C" {
+#include "libavcodec/avcodec.h"
+}
+
+#include <cstdint>
+
+class FrameDecimator {
+public:
+    // 跳转后重新估计帧率和 GOP 结构
+    void reset();
+
+    // 每个解码输出的帧调用一次（显示顺序），time 单位秒
+    void observe(double time, enum AVPictureType pictType);
+
+    // 这一帧是否送去显示；refreshRate 为屏幕刷新率，speed 为播放倍速
+    bool keep(double refreshRate, double speed);
+
+    // 解码器可以跳过的帧：AVDISCARD_NONREF 或 AVDISCARD_DEFAULT
+    AVDiscard skipFrame() const;
+
+private:
+    double lastTime = -1.0;
+    double interval = 0.0;     // 相邻帧间隔的滑动平均（秒）
+    int alternating = 0;       // 连续满足 B/非 B 交替的帧数
+    bool prevB = false;
+    double phase = 1.0;        // 均匀抽取的累加相位，>= 1 时保留一帧
+    bool skipNonRef = false;
+};
+
+#endif //ANDROIDPLAYER_FRAMEDECIMATOR_H
@@ -0,0 +1,47 @@
+//
+// framePool.h
+// 按尺寸和格式分组的视频帧缓冲池，帧释放后缓冲区回到池中复用
+//
+
+#ifndef ANDROIDPLAYER_FRAMEPOOL_H
+#define ANDROIDPLAYER_FRAMEPOOL_H
+
+extern "C" {
+#include "libavutil/buffer.h"
+#include "libavutil/frame.h"
+}
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+
+class FramePool {
+public:
+    explicit FramePool(size_t maxPools = 4);
+    ~FramePool();
+
+    // 取一帧，data 指向池中的缓冲区，行按 align 字节对齐；av_frame_free 后缓冲区自动归还
+    AVFrame* acquire(int width, int height, AVPixelFormat format, int align = 64);
+
+    int64_t getHits() const;
+    int64_t getMisses() const;
+
+private:
+    struct Entry {
+        int width;
+        int height;
+        AVPixelFormat format;
+        int align;
+        AVBufferPool* pool;
+    };
+
+    static AVBufferRef* allocBuffer(void* opaque, size_t size);
+
+    std::list<Entry> entries;  // 头部为最近使用，尺寸切换后旧的池会被淘汰
+    size_t maxPools;
+    std::atomic<int64_t> requests{0};
+    std::atomic<int64_t> misses{0};
+};
+
+
+#endif //ANDROIDPLAYER_FRAMEPOOL_H
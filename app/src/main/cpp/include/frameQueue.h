@@ -17,21 +17,34 @@ extern "C" {
 
 class FrameQueue {
 public:
-    FrameQueue();
+    // maxFrames / maxBytes 为 0 表示不限制
+    explicit FrameQueue(size_t maxFrames = 0, size_t maxBytes = 0);
     ~FrameQueue();
 
+    // 队列满时阻塞，直到有空间或 setFinished
     void push(AVFrame *frame);
+    // 阻塞到有帧；setFinished 或 interrupt 后返回空，用 isFinished 区分
     AVFrame* pop();
+    // 让正在（或下一次）阻塞的 pop 返回空一次
+    void interrupt();
     void clear();
     void setFinished(bool isFinished);
     bool isFinished() const;
     bool empty() const;
 
 private:
+    static size_t frameBytes(const AVFrame *frame);
+    bool full() const;
+
     std::queue<AVFrame*> queue;
     mutable std::mutex mtx;
     std::condition_variable cv;
+    std::condition_variable notFull;
     bool finished = false;
+    bool interrupted = false;
+    size_t maxFrames;
+    size_t maxBytes;
+    size_t bytes = 0;
 };
 
 
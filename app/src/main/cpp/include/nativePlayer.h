@@ -0,0 +1,105 @@
+//
+// nativePlayer.h
+// 一个播放器实例的全部 native 状态：输入、队列、时钟、线程和任务。Java 层 Player.nativeContext 持有它的指针，
+// 多个实例互不影响，可以同时播放
+//
+
+#ifndef ANDROIDPLAYER_NATIVEPLAYER_H
+#define ANDROIDPLAYER_NATIVEPLAYER_H
+
+extern "C" {
+#include <libavformat/avformat.h>
+#include <android/native_window.h>
+}
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include "packetQueue.h"
+#include "frameQueue.h"
+#include "audioRingBuffer.h"
+#include "timer.h"
+#include "playerStats.h"
+#include "surfaceSize.h"
+#include "surfaceSlot.h"
+#include "playbackControl.h"
+#include "frameCache.h"
+#include "speculativeDecoder.h"
+#include "taskScheduler.h"
+#include "standbyCache.h"
+
+class NativePlayer {
+public:
+    NativePlayer();
+    ~NativePlayer();
+
+    // 在后台线程打开、探测文件，启动各线程并预滚动：第一帧上传到纹理、第一段音频写入设备后停住，
+    // 然后调用 onPrepared(0)；失败时调用 onPrepared(错误码)。回调在 native 线程上。window 的引用由播放器持有，stop 时释放
+    int prepare(const char* path, ANativeWindow* window, std::function<void(int)> onPrepared);
+    // 开始播放；prepare 还没就绪时也可以调用，就绪后立即输出
+    int start();
+    int stop();
+    void pause(bool paused);
+    // 播放中换 Surface：null 表示分离（进入后台），音频照常播放，视频只解关键帧；新的 Surface 只在原来的
+    // EGL 上下文上创建 EGLSurface。返回时旧窗口已不再使用，引用由播放器释放
+    void setSurface(ANativeWindow* window);
+    // 纯音频：视频流在解复用层丢弃，视频解码和渲染停下；退出时视频跳到当前音频位置继续
+    int setAudioOnly(bool audioOnly);
+
+    int seek(double position);
+    void hintSeek(double position);
+    void beginScrub();
+    int endScrub(double position);
+    int stepForward();
+    int stepBackward();
+    int setSpeed(float speed);
+    int setLoop(double start, double end);
+    void setRefreshRate(float hz);
+
+    double getPosition() const;
+    double getDuration() const;
+    std::string getStats() const;
+
+private:
+    void runPrepare();
+    double frameDuration() const;
+    double toLoopPosition(double time) const;
+    void seekTo(double target, int direction);
+
+    PacketQueue* packetQueue = nullptr;
+    PacketQueue* audioPacketQueue = nullptr;
+    FrameQueue* frameQueue = nullptr;
+    AudioRingBuffer* audioRingBuffer = nullptr;
+    AVFormatContext* formatCtx = nullptr;
+    int videoStreamIndex = -1;
+    int audioStreamIndex = -1;
+    AVRational videoTimeBase{0, 1};
+    ANativeWindow* nativeWindow = nullptr;
+    SurfaceSize surfaceSize;       // 渲染线程更新，解码线程按它决定转换尺寸
+    SurfaceSlot surfaceSlot;       // 渲染线程当前的输出窗口
+    std::string videoPath;
+    std::atomic<bool> isInited{false}; // 是否初始化完成，prepare 线程设置
+    std::thread prepareThread;
+    std::function<void(int)> onPrepared;
+
+    Timer timer;
+    PlayerStats stats;
+    PlaybackControl control;       // 跳转序号和当前显示位置
+    FrameCache frameCache;
+    SpeculativeDecoder speculative; // 提示的跳转目标在后台预解码
+    std::unique_ptr<StandbyEntry> standby; // 热备缓存开启时，本次播放的输入和解码器，stop 时放回缓存
+    bool resumeAfterScrub = false;  // 拖动前正在播放
+
+    // 解复用和音频解码在共享的调度器上运行；视频解码、渲染（持有 EGL 上下文）和音频输出仍各占一个线程。
+    // stop 时唤醒并等待全部退出
+    std::shared_ptr<Task> demuxTask;
+    std::shared_ptr<Task> audioDecodeTask;
+    int demuxListener = -1;        // 在 control 上登记的唤醒
+    std::thread decoderThread;
+    std::thread rendererThread;
+    std::thread aAudioPlayerThread;
+};
+
+#endif //ANDROIDPLAYER_NATIVEPLAYER_H
@@ -14,6 +14,7 @@ extern "C" {
 #include <queue>
 #include <mutex>
 #include <condition_variable>
+#include <functional>
 
 class PacketQueue {
 public:
@@ -22,17 +23,34 @@ public:
 
     void push(AVPacket *pkt);
     AVPacket* pop();
+    // 不阻塞，队列为空时返回 nullptr
+    AVPacket* tryPop();
     void clear();
     void setFinished(bool isFinished);
     bool isFinished() const;
     bool empty() const;
+    size_t size() const;
+
+    // 调度器上的任务不能阻塞等待：入队（或结束）时通知消费者，出队（或清空、结束）时通知生产者。
+    // 在开始读写之前设置，回调在锁外调用
+    void setPushListener(std::function<void()> listener);
+    void setPopListener(std::function<void()> listener);
 
 private:
+    static void notify(const std::function<void()>& listener);
+
     std::queue<AVPacket*> queue;
     mutable std::mutex mtx;
     std::condition_variable cv;
     bool finished = false;
+    std::function<void()> onPush;
+    std::function<void()> onPop;
 };
 
+// 解复用线程在文件结束时送入的空包
+inline bool isEndOfStream(const AVPacket *pkt) {
+    return !pkt->data && pkt->size == 0 && !pkt->side_data_elems;
+}
+
 
 #endif //ANDROIDPLAYER_PACKETQUEUE_H
@@ -0,0 +1,122 @@
+//
+// playbackControl.h
+// 跳转请求和播放进度在各线程间的同步：每次跳转递增序号，包和帧带上序号，旧序号的数据直接丢弃
+//
+
+#ifndef ANDROIDPLAYER_PLAYBACKCONTROL_H
+#define ANDROIDPLAYER_PLAYBACKCONTROL_H
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include "cancelToken.h"
+
+// 高倍速播放的解码策略
+enum class TrickMode {
+    None,       // 正常解码
+    NonRef,     // 2x-4x：解码器丢弃非参考帧
+    Keyframes,  // 4x 以上：只读关键帧，逐个关键帧定位，音频静音
+};
+
+class PlaybackControl {
+public:
+    // 新的播放开始前调用
+    void reset();
+
+    // 发起跳转（单位：秒），返回新的序号；direction < 0 表示从目标开始倒放
+    int requestSeek(double target, int direction = 1);
+    int getSerial() const;
+    void getSeek(int& serial, double& target) const;
+    int getDirection() const;
+
+    // A-B 循环区间（单位：秒），end <= start 表示关闭；修改后需要一次跳转让各线程生效
+    void setLoop(double start, double end);
+    bool getLoop(double& start, double& end) const;
+
+    // 拖动进度条期间的跳转只解码最近的关键帧做预览
+    void setScrubbing(bool scrubbing);
+    bool isScrubbing() const;
+
+    // 播放倍速，决定 TrickMode；进出 Keyframes 需要一次跳转让各线程切换
+    void setSpeed(double speed);
+    double getSpeed() const;
+    TrickMode getTrickMode() const;
+
+    // 纯音频：解复用丢弃视频流，视频解码和渲染没有输入而停下；退出时需要一次跳转让视频回到音频的位置
+    void setAudioOnly(bool audioOnly);
+    bool isAudioOnly() const;
+
+    // 暂停是整条流水线的状态：音频设备暂停，解复用和解码到水位后停下，渲染不再轮询
+    void setPaused(bool paused);
+    bool isPaused() const;
+    // 暂停中移动了主时钟（逐帧步进），唤醒等待显示时间的渲染线程
+    void nudge();
+    // 渲染线程的输出窗口要换：标记留到渲染线程取走为止，期间暂停等待和 sleepFor 立即返回 true
+    void signalSurface();
+    bool takeSurfaceSignal();
+    // 阻塞到恢复播放（返回 true）或停止（返回 false）
+    bool waitUntilResumed();
+    // 暂停中阻塞，恢复、nudge 或 signalSurface 时返回 true，跳转或停止时返回 false
+    bool waitWhilePaused(int serial);
+
+    // 预滚动：prepare 时登记需要就绪的输出阶段数，各阶段备好第一帧/第一段音频后调用 prerollDone，
+    // 全部就绪时在最后一个阶段的线程上调用 onReady；停止后不再回调
+    void beginPreroll(int stages, std::function<void()> onReady);
+    void prerollDone();
+    bool isPrerolling() const;
+
+    // 跳转、停止、暂停/恢复和 nudge 后调用，用来唤醒调度器上的任务和其他线程里的等待。
+    // 回调持锁调用（里面不要再登记或注销），removeListener 返回后不会再被调用
+    int addListener(std::function<void()> listener);
+    void removeListener(int id);
+
+    // 停止：取消 token，唤醒所有等待；各线程看到后尽快退出
+    void stop();
+    bool isStopped() const;
+    CancelToken* cancelToken();
+
+    // 睡 seconds 秒，跳转（serial 变化）或停止时提前返回 false；暂停/恢复或 nudge 时提前返回 true，由调用方重新计算
+    bool sleepFor(double seconds, int serial);
+
+    // 渲染线程最近一次显示的帧 pts（流时间基）
+    void setDisplayedPts(int64_t pts);
+    int64_t getDisplayedPts() const;
+
+private:
+    void notifyListeners();
+
+    mutable std::mutex mtx;
+    std::condition_variable cv;
+    CancelToken token;
+    std::atomic<bool> paused{false};
+    std::atomic<bool> audioOnly{false};
+    int clockEpoch = 0;  // 每次 nudge 递增
+    bool surfacePending = false;  // signalSurface 之后渲染线程还没取走
+    int prerollStages = 0;
+    std::function<void()> prerollReady;
+    std::mutex listenerMtx;
+    std::map<int, std::function<void()>> listeners;
+    int nextListenerId = 0;
+    std::atomic<int> serial{0};
+    double seekTarget = 0.0;
+    std::atomic<int> direction{1};
+    std::atomic<bool> scrubbing{false};
+    std::atomic<double> speed{1.0};
+    double loopStart = 0.0;
+    double loopEnd = 0.0;
+    std::atomic<int64_t> displayedPts{INT64_MIN};
+};
+
+// 序号存放在 AVPacket/AVFrame 的 opaque 字段里
+inline void* serialTag(int serial) {
+    return (void*) (intptr_t) serial;
+}
+
+inline int serialOf(const void* opaque) {
+    return (int) (intptr_t) opaque;
+}
+
+#endif //ANDROIDPLAYER_PLAYBACKCONTROL_H
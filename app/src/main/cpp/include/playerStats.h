@@ -0,0 +1,159 @@
+//
+// playerStats.h
+// 播放器运行统计，每个播放器实例一份，各线程写入，Java 层通过 nativeGetStats 读取
+//
+
+#ifndef ANDROIDPLAYER_PLAYERSTATS_H
+#define ANDROIDPLAYER_PLAYERSTATS_H
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <time.h>
+
+struct PlayerStats {
+    // 解码线程策略
+    std::atomic<int> decodeThreadType{0};
+    std::atomic<int> decodeThreadCount{0};
+    std::atomic<int> cpuBigCores{0};
+    std::atomic<int> cpuLittleCores{0};
+
+    // 视频解码耗时：send/receive 的实际时间，以及解码线程在其中花的 CPU 时间（帧线程模式下 FFmpeg 工作线程的不算）
+    std::atomic<int64_t> decodedFrames{0};
+    std::atomic<int64_t> decodeTimeUs{0};
+    std::atomic<int64_t> decodeCpuUs{0};
+
+    // 颜色转换
+    std::atomic<const char*> convertKernel{"none"};
+    std::atomic<int> convertSlices{0};
+    std::atomic<int64_t> convertedFrames{0};
+    std::atomic<int64_t> convertTimeUs{0};
+    std::atomic<int64_t> swsCacheHits{0};
+    std::atomic<int64_t> swsCacheMisses{0};
+
+    // 像素吞吐：源分辨率像素 vs 实际转换、上传的像素
+    std::atomic<int64_t> startTimeUs{0};
+    std::atomic<int64_t> sourcePixels{0};
+    std::atomic<int64_t> convertedPixels{0};
+    std::atomic<int64_t> uploadedPixels{0};
+
+    // 输出帧缓冲池
+    std::atomic<int64_t> framePoolHits{0};
+    std::atomic<int64_t> framePoolMisses{0};
+
+    // 已解码帧缓存（步进/回退）
+    std::atomic<int64_t> frameCacheHits{0};
+    std::atomic<int64_t> frameCacheMisses{0};
+
+    // 倒放：显示的帧 vs 实际解码的帧（分段重新解码会多解）
+    std::atomic<int64_t> reverseFrames{0};
+    std::atomic<int64_t> reverseDecodedFrames{0};
+
+    // A-B 循环：回绕次数，其中从内存缓存重放的遍数
+    std::atomic<int64_t> loopWraps{0};
+    std::atomic<int64_t> loopReplayedPasses{0};
+
+    // 拖动进度条：收到的跳转请求 vs 实际解码显示的关键帧预览（差值是被合并掉的请求）
+    std::atomic<int64_t> scrubRequests{0};
+    std::atomic<int64_t> scrubPreviews{0};
+
+    // 推测性预解码：跳转命中/未命中，预解码总耗时，其中没被用到就丢弃的部分
+    std::atomic<int64_t> speculativeHits{0};
+    std::atomic<int64_t> speculativeMisses{0};
+    std::atomic<int64_t> speculativeDecodeUs{0};
+    std::atomic<int64_t> speculativeWastedUs{0};
+
+    // 高倍速只读关键帧时送出的关键帧数
+    std::atomic<int64_t> trickKeyframes{0};
+
+    // 实际显示的帧，刷新率跟不上时在转换前抽掉的帧，以及到渲染线程时已经过了显示时间而丢掉的帧
+    std::atomic<int64_t> presentedFrames{0};
+    std::atomic<int64_t> decimatedFrames{0};
+    std::atomic<int64_t> lateFrames{0};
+
+    // 静止帧：省掉转换和上传的帧数，估算省下的转换耗时和上传字节，以及抽样哈希本身的耗时
+    std::atomic<int64_t> elidedFrames{0};
+    std::atomic<int64_t> elidedConvertUs{0};
+    std::atomic<int64_t> elidedBytes{0};
+    std::atomic<int64_t> staticHashUs{0};
+
+    // 各线程/任务从阻塞中醒来的次数，空闲和暂停时应接近 0，稳定播放时与实际处理的包/帧数相当
+    std::atomic<int64_t> demuxWakeups{0};
+    std::atomic<int64_t> audioDecodeWakeups{0};
+    std::atomic<int64_t> videoDecodeWakeups{0};
+    std::atomic<int64_t> renderWakeups{0};
+    std::atomic<int64_t> audioOutputWakeups{0};
+
+    // 启动耗时：prepare 开始到预滚动就绪，start 到第一帧显示；还没发生时为 -1。
+    // 渲染器初始化（EGL + 着色器程序）与打开、探测并行，单独统计，以及程序是否来自二进制缓存
+    std::atomic<int64_t> prepareUs{-1};
+    std::atomic<int64_t> rendererInitUs{0};
+    std::atomic<int64_t> programUs{0};
+    std::atomic<bool> programCached{false};
+    std::atomic<int64_t> startRequestUs{0};
+    std::atomic<int64_t> firstFrameUs{-1};
+
+    // Surface 分离次数，最近一次重新附着到画出帧的耗时（-1 表示还没有）
+    std::atomic<int64_t> surfaceDetaches{0};
+    std::atomic<int64_t> reattachUs{-1};
+
+    // 纯音频模式：两种模式下各自累计的本播放器 CPU 时间（见 pipelineCpuUs）和实际时间，比较 CPU 占用得出省下的部分
+    std::atomic<bool> audioOnly{false};
+    std::atomic<int64_t> modeStartUs{0};
+    std::atomic<int64_t> modeStartCpuUs{0};
+    std::atomic<int64_t> videoModeUs{0};
+    std::atomic<int64_t> videoModeCpuUs{0};
+    std::atomic<int64_t> audioOnlyUs{0};
+    std::atomic<int64_t> audioOnlyCpuUs{0};
+
+    // 热备缓存：0 关闭，1 未命中，2 命中；命中时直接显示的第一个 GOP 帧数
+    std::atomic<int> standbyState{0};
+    std::atomic<int64_t> standbyFrames{0};
+
+    // 本播放器的 CPU 时间：独占线程（视频解码、渲染、音频输出、倒放和预解码）在 ThreadScope 里登记，
+    // 共享调度器上的任务和转换线程池按 CpuSpan 结算。多个播放器同时运行时，进程的 CPU 时间说明不了某一个
+    std::atomic<int64_t> taskCpuUs{0};
+    std::atomic<int64_t> sliceCpuUs{0};
+    int64_t pipelineCpuUs() const;
+
+    // 当前线程的 CPU 时间（微秒）
+    static int64_t threadCpuUs(clockid_t clock = CLOCK_THREAD_CPUTIME_ID);
+
+    // 线程开始时构造、退出前析构，期间这个线程的 CPU 时间算进本播放器
+    class ThreadScope {
+    public:
+        explicit ThreadScope(PlayerStats* stats);
+        ~ThreadScope();
+    private:
+        PlayerStats* stats;
+        clockid_t clock;
+    };
+
+    // 在共享线程上执行的一段工作，结束时把这段 CPU 时间加到 sink
+    class CpuSpan {
+    public:
+        explicit CpuSpan(std::atomic<int64_t>& sink) : sink(sink), start(threadCpuUs()) {}
+        ~CpuSpan() { sink += threadCpuUs() - start; }
+    private:
+        std::atomic<int64_t>& sink;
+        int64_t start;
+    };
+
+    void reset();
+    // prepare 就绪、调用 start、start 后第一次显示时分别调用
+    void markPrepared();
+    void markStart();
+    void markFirstFrame();
+    // 切换纯音频模式时调用，结算上一段的 CPU 时间
+    void markAudioOnly(bool enabled);
+    std::string toString() const;
+
+private:
+    mutable std::mutex threadMtx;
+    std::vector<clockid_t> threadClocks;  // 正在运行的登记线程
+    int64_t exitedThreadCpuUs = 0;        // 已退出的登记线程
+};
+
+#endif //ANDROIDPLAYER_PLAYERSTATS_H
@@ -0,0 +1,18 @@
+//
+// programCache.h
+// 已链接 GL 程序的二进制缓存：驱动支持 GL_OES_get_program_binary 时把程序存到应用缓存目录，之后启动跳过着色器编译
+//
+
+#ifndef ANDROIDPLAYER_PROGRAMCACHE_H
+#define ANDROIDPLAYER_PROGRAMCACHE_H
+
+#include <GLES2/gl2.h>
+#include <string>
+
+// 进程内所有播放器共用一个缓存目录，没有设置时每次都编译
+void setProgramCacheDir(const std::string& dir);
+
+// 在当前 EGL 上下文中创建程序：缓存命中时直接加载二进制，否则编译链接后写入缓存。cached 返回是否命中
+GLuint loadProgram(const char* vertexSrc, const char* fragmentSrc, bool* cached);
+
+#endif //ANDROIDPLAYER_PROGRAMCACHE_H
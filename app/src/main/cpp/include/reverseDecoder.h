@@ -0,0 +1,65 @@
+//
+// reverseDecoder.h
+// 倒放：按关键帧把文件切成 GOP，从后往前逐个 GOP 解码，整批帧交给解码线程倒序显示
+//
+
+#ifndef ANDROIDPLAYER_REVERSEDECODER_H
+#define ANDROIDPLAYER_REVERSEDECODER_H
+
+extern "C" {
+#include "libavformat/avformat.h"
+#include "libavcodec/avcodec.h"
+}
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "playbackControl.h"
+#include "timer.h"
+#include "playerStats.h"
+
+class ReverseDecoder {
+public:
+    // 自己打开一份文件和解码器，serial 变化或停止播放即取消
+    ReverseDecoder(const char* path, int lowres, PlaybackControl* control, Timer* timer, PlayerStats* stats, int serial);
+    ~ReverseDecoder();
+
+    // 在后台线程从 startPts（含）开始往前解码，上一个 GOP 和当前 GOP 的显示并行
+    bool start(int64_t startPts);
+
+    // 取下一批帧（显示顺序，调用方倒序显示并释放），到达文件开头或被取消时返回 false
+    bool nextBatch(std::vector<AVFrame*>& frames);
+
+private:
+    void run(int64_t startPts);
+    bool readGop(int64_t endPts, std::vector<AVPacket*>& packets, int64_t& keyPts);
+    int decodeSegment(const std::vector<AVPacket*>& packets, int64_t keyPts, int64_t endPts,
+                      std::deque<AVFrame*>& frames);
+    bool pushBatch(std::deque<AVFrame*>& frames);
+    bool cancelled() const;
+
+    AVFormatContext* formatCtx = nullptr;
+    AVCodecContext* codecCtx = nullptr;
+    int streamIndex = -1;
+    int lowres;
+    PlaybackControl* control;
+    Timer* timer;
+    PlayerStats* stats;
+    int serial;
+    size_t segmentFrames = 0;  // 每段最多保留的帧数，按第一帧的大小和内存预算计算
+
+    std::thread worker;
+    mutable std::mutex mtx;
+    std::condition_variable cv;
+    std::deque<std::vector<AVFrame*>> batches;
+    bool done = false;
+    std::atomic<bool> stopping{false};
+    int controlListener = -1;  // 跳转和停止时唤醒 cv 上的等待
+};
+
+
+#endif //ANDROIDPLAYER_REVERSEDECODER_H
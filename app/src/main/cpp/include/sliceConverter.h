@@ -0,0 +1,78 @@
+//
+// sliceConverter.h
+// 把一帧的颜色转换按水平条带拆分，每个条带作为任务交给进程共享的 TaskScheduler 并行执行，
+// 解码线程只负责发起和收取；不再为每个播放器单独开转换线程
+//
+
+#ifndef ANDROIDPLAYER_SLICECONVERTER_H
+#define ANDROIDPLAYER_SLICECONVERTER_H
+
+extern "C" {
+#include "libavutil/frame.h"
+#include "libswscale/swscale.h"
+}
+
+#include <chrono>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <vector>
+#include "swsCache.h"
+#include "taskScheduler.h"
+
+class SliceConverter {
+public:
+    // maxSlices：一帧最多拆成的条带数，不超过调度器的工作线程数
+    explicit SliceConverter(int maxSlices);
+    ~SliceConverter();
+
+    // 源帧参数变化时调用，从缓存中取出对应的转换状态，必须在 wait() 之后调用
+    bool configure(const ConvertKey& key);
+
+    // 异步转换，src/dst 在 wait() 返回前必须保持有效
+    void start(const AVFrame* src, AVFrame* dst);
+
+    // 等待当前转换完成，返回这一帧的转换耗时（微秒）
+    int64_t wait();
+    // 调度器线程上执行转换累计的 CPU 时间（微秒）
+    int64_t getCpuUs() const;
+
+    const char* getKernelName() const;
+    int getSliceCount() const;
+    const SwsCache& getCache() const;
+
+private:
+    // 一个条带：每次 wake 转换一次，然后 Blocked 等下一帧
+    class SliceTask : public Task {
+    public:
+        SliceTask(SliceConverter* owner, int index) : owner(owner), index(index) {}
+        Status step() override;
+
+    private:
+        SliceConverter* owner;
+        int index;
+    };
+
+    void convertSlice(int index);
+    void sliceDone();
+
+    int maxSlices;
+    std::vector<std::shared_ptr<SliceTask>> tasks;  // 按条带序号复用，稳定播放时不再分配
+    SwsCache cache;
+    ConvertPlan* plan = nullptr;
+
+    const AVFrame* curSrc = nullptr;
+    AVFrame* curDst = nullptr;
+    std::chrono::steady_clock::time_point startTime;
+    int64_t lastConvertUs = 0;
+
+    std::mutex mtx;
+    std::condition_variable cv;
+    int pendingSlices = 0;
+    std::atomic<int64_t> cpuUs{0};
+};
+
+
+#endif //ANDROIDPLAYER_SLICECONVERTER_H
@@ -0,0 +1,79 @@
+//
+// speculativeDecoder.h
+// 推测性跳转预解码：用第二个解码器和单独打开的文件，提前解码提示位置（章节点、±10s 按钮）附近的几帧，
+// 真正跳转到这些位置时直接拿来显示。文件和解码器在第一个提示到来时才在后台打开，提示都用完或过期后关闭
+//
+
+#ifndef ANDROIDPLAYER_SPECULATIVEDECODER_H
+#define ANDROIDPLAYER_SPECULATIVEDECODER_H
+
+extern "C" {
+#include "libavformat/avformat.h"
+#include "libavcodec/avcodec.h"
+}
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "playerStats.h"
+
+class SpeculativeDecoder {
+public:
+    explicit SpeculativeDecoder(PlayerStats* stats);
+    ~SpeculativeDecoder();
+
+    // 由视频解码线程在解码器打开后调用，lowres 与主解码器一致；只记下参数，不打开文件
+    void open(const char* path, int lowres);
+    void close();
+
+    // 提示一个可能的跳转目标（单位：秒），ttl 秒内没有用到就丢弃
+    void hint(double target, double ttl);
+
+    // 跳转时调用：预解码的帧覆盖 targetPts 时取出从覆盖帧开始的几帧（新引用，显示顺序）
+    bool take(int64_t targetPts, std::vector<AVFrame*>& frames);
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Entry {
+        int id;
+        double target;
+        Clock::time_point expiry;
+        bool decoded = false;
+        std::vector<AVFrame*> frames;
+        int64_t decodeUs = 0;
+    };
+
+    void run();
+    bool openInput();
+    void closeInput();
+    int64_t decodeAt(double target, std::vector<AVFrame*>& frames);
+    void expire();
+    static void freeEntry(Entry& entry);
+    static int isClosing(void* opaque);
+
+    PlayerStats* stats;
+    std::string path;
+    int lowres = 0;
+    AVFormatContext* formatCtx = nullptr;
+    AVCodecContext* codecCtx = nullptr;
+    int streamIndex = -1;
+
+    std::thread worker;        // 有提示时运行，没有提示后关闭输入并退出
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::list<Entry> entries;  // 头部为最新的提示
+    int nextId = 0;
+    bool accepting = false;    // open 之后、close 之前接受提示
+    bool workerActive = false; // 后台线程还没决定退出
+    std::atomic<bool> running{false};  // 修改时持有 mtx；FFmpeg 的 interrupt_callback 不持锁读取
+};
+
+
+#endif //ANDROIDPLAYER_SPECULATIVEDECODER_H
@@ -0,0 +1,84 @@
+//
+// standbyCache.h
+// 停止后的热备缓存：保留最近播放过的输入（已探测的 AVFormatContext、打开的音视频解码器、文件开头第一个 GOP 的解码帧），
+// 按条目数和内存预算做 LRU，重新播放同一个文件只需要一次定位
+//
+
+#ifndef ANDROIDPLAYER_STANDBYCACHE_H
+#define ANDROIDPLAYER_STANDBYCACHE_H
+
+extern "C" {
+#include <libavformat/avformat.h>
+#include <libavcodec/avcodec.h>
+}
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "cancelToken.h"
+
+// 一个输入的可复用状态；播放期间归 NativePlayer 所有，解码线程和音频解码任务取用、结束时交还解码器
+class StandbyEntry {
+public:
+    std::string path;
+    int64_t fileSize = -1;           // 打开时文件的大小和修改时间，同一路径的文件被替换后不再复用
+    int64_t fileMtimeNs = 0;
+    AVFormatContext* formatCtx = nullptr;
+    AVCodecContext* videoCodecCtx = nullptr;
+    AVCodecContext* audioCodecCtx = nullptr;
+    std::vector<AVFrame*> firstGop;  // 文件开头的解码帧（YUV 引用），显示顺序
+    bool firstGopDone = false;       // 已收齐，或超出预算放弃
+
+    ~StandbyEntry();
+
+    // 打开输入时设置到 interrupt_callback。FFmpeg 打开时把它复制进 AVIOContext，之后改不了，
+    // 所以回调指向条目本身，再转发给当前播放器的取消 token；放进缓存前解绑
+    AVIOInterruptCB interruptCallback();
+    void bind(const CancelToken* token);
+
+    // 打开前记下文件的大小和修改时间；不是本地文件（stat 失败）时返回 false，不能放进缓存
+    bool stampFile();
+    // 文件还是打开时的那一个
+    bool fileUnchanged() const;
+
+    // 解码线程按显示顺序交来文件开头的帧，遇到下一个关键帧或超出预算时结束
+    void captureFirstGop(const AVFrame* frame);
+    // 估算的内存占用：缓存的帧加上解码器内部的参考帧
+    size_t bytes() const;
+
+private:
+    static int isInterrupted(void* opaque);
+
+    std::atomic<const CancelToken*> cancelToken{nullptr};
+};
+
+class StandbyCache {
+public:
+    static StandbyCache& instance();
+
+    // 最多保留 maxEntries 个输入、总共 maxBytes 字节；maxEntries 为 0 时关闭（默认）
+    void configure(size_t maxEntries, size_t maxBytes);
+    bool enabled();
+
+    // 取出 path 对应的条目（从缓存中移除），没有或文件已经变了时返回空
+    std::unique_ptr<StandbyEntry> take(const std::string& path);
+    // 放入一个条目，成为最近使用的；超出条目数或预算时淘汰最久没用的
+    void put(std::unique_ptr<StandbyEntry> entry);
+    // 内存紧张时调用，只保留最近的 keep 个
+    void trim(size_t keep);
+
+private:
+    void evictLocked(size_t keep, size_t budget);
+
+    std::mutex mtx;
+    std::list<std::unique_ptr<StandbyEntry>> entries;  // 头部为最近使用
+    size_t maxEntries = 0;
+    size_t maxBytes = 0;
+};
+
+#endif //ANDROIDPLAYER_STANDBYCACHE_H
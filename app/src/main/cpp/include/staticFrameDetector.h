@@ -0,0 +1,46 @@
+//
+// staticFrameDetector.h
+// 静止帧检测：录屏里大量与上一帧完全相同的帧，不必再做颜色转换和纹理上传。
+// H.264 只含跳过宏块的小 P 帧包（没有 B 帧重排序时）直接判定为不变，其余帧先用抽样行的 SIMD 哈希
+// 快速排除，与上一次显示的帧哈希相同时再逐字节确认
+//
+
+#ifndef ANDROIDPLAYER_STATICFRAMEDETECTOR_H
+#define ANDROIDPLAYER_STATICFRAMEDETECTOR_H
+
+extern "C" {
+#include "libavcodec/avcodec.h"
+#include "libavutil/frame.h"
+}
+
+#include <cstdint>
+
+class StaticFrameDetector {
+public:
+    StaticFrameDetector();
+    ~StaticFrameDetector();
+
+    // 送入解码器前调用：H.264 非关键帧且小到只能是全跳过宏块的包做上标记，随 opaque_ref 带到解码出的帧上
+    // （需要 AV_CODEC_FLAG_COPY_OPAQUE）
+    static void tagPacket(AVPacket* pkt, AVCodecID codecId);
+
+    // 与上一次显示的帧内容相同时返回 true；返回 false 时这一帧成为新的比较基准。
+    // reordered（解码器有 B 帧重排序）时包标记不可信，总是比较内容
+    bool isUnchanged(const AVFrame* frame, bool reordered);
+
+    // 上一次显示之后有帧没有经过这里（跳转、抽帧丢弃），下一帧不能只凭包大小判断
+    void invalidate();
+
+    int64_t getHashUs() const;
+
+private:
+    static uint64_t hashFrame(const AVFrame* frame);
+    static bool samePixels(const AVFrame* a, const AVFrame* b);
+
+    bool valid = false;     // 基准帧就是上一次显示的帧
+    AVFrame* reference;     // 基准帧的引用
+    uint64_t lastHash = 0;
+    int64_t hashUs = 0;
+};
+
+#endif //ANDROIDPLAYER_STATICFRAMEDETECTOR_H
@@ -0,0 +1,24 @@
+//
+// surfaceSize.h
+// 输出 Surface 的当前尺寸，由渲染线程更新，解码线程据此决定转换的目标尺寸；
+// 以及所在屏幕的刷新率，解码线程据此抽帧；Surface 分离时解码线程只解关键帧
+//
+
+#ifndef ANDROIDPLAYER_SURFACESIZE_H
+#define ANDROIDPLAYER_SURFACESIZE_H
+
+#include <atomic>
+
+struct SurfaceSize {
+    std::atomic<int> width{0};
+    std::atomic<int> height{0};
+    std::atomic<float> refreshRate{60.0f};
+    std::atomic<bool> attached{true};
+
+    void set(int w, int h) {
+        width = w;
+        height = h;
+    }
+};
+
+#endif //ANDROIDPLAYER_SURFACESIZE_H
@@ -0,0 +1,46 @@
+//
+// surfaceSlot.h
+// 渲染线程使用的输出窗口：播放中可以分离（null）或换成新的 Surface。
+// set 阻塞到渲染线程放下旧窗口为止，Java 的 surfaceDestroyed 返回后旧窗口不能再被使用
+//
+
+#ifndef ANDROIDPLAYER_SURFACESLOT_H
+#define ANDROIDPLAYER_SURFACESLOT_H
+
+extern "C" {
+#include <android/native_window.h>
+}
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+
+class SurfaceSlot {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // 唤醒渲染线程的等待（frameQueue、暂停、等显示时间）；必须在等待条件里留下标记，set 只调用一次
+    void setWaker(std::function<void()> waker);
+
+    // 任意线程：换窗口；渲染线程运行中时阻塞到它确认
+    void set(ANativeWindow* window);
+
+    // 渲染线程：开始时取当前窗口，之后的 set 都等它确认；退出时 close，set 不再等待
+    ANativeWindow* open();
+    void close();
+    // 渲染线程：有新窗口时返回 true，换好后调用 acknowledge。requested 是 set 的调用时间
+    bool poll(ANativeWindow*& window, Clock::time_point& requested);
+    void acknowledge();
+
+private:
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::function<void()> waker;
+    ANativeWindow* window = nullptr;
+    Clock::time_point requested;
+    bool changed = false;
+    bool active = false;
+};
+
+#endif //ANDROIDPLAYER_SURFACESLOT_H
@@ -0,0 +1,73 @@
+//
+// swsCache.h
+// 颜色转换上下文的 LRU 缓存，码流分辨率/格式来回切换时不用重新初始化
+//
+
+#ifndef ANDROIDPLAYER_SWSCACHE_H
+#define ANDROIDPLAYER_SWSCACHE_H
+
+extern "C" {
+#include "libavutil/frame.h"
+#include "libswscale/swscale.h"
+}
+
+#include <cstdint>
+#include <list>
+#include <vector>
+#include "yuvConverter.h"
+
+struct ConvertKey {
+    int srcWidth = 0;
+    int srcHeight = 0;
+    AVPixelFormat srcFormat = AV_PIX_FMT_NONE;
+    AVColorSpace colorspace = AVCOL_SPC_UNSPECIFIED;
+    AVColorRange range = AVCOL_RANGE_UNSPECIFIED;
+    int dstWidth = 0;
+    int dstHeight = 0;
+    AVPixelFormat dstFormat = AV_PIX_FMT_NONE;
+
+    static ConvertKey fromFrame(const AVFrame* src, int dstWidth, int dstHeight, AVPixelFormat dstFormat);
+    bool operator==(const ConvertKey& other) const;
+    bool operator!=(const ConvertKey& other) const;
+};
+
+// 一组转换参数对应的全部状态：同尺寸时用 SIMD 内核或每个条带一个 SwsContext，
+// 需要缩放时用一个自带线程的 SwsContext 整帧处理
+struct ConvertPlan {
+    ConvertKey key;
+    YuvConverter yuvConverter;
+    bool useYuvConverter = false;
+    SwsContext* scaler = nullptr;
+    std::vector<SwsContext*> swsSlices;
+    std::vector<int> sliceRows;   // 第 i 个条带覆盖源帧 [sliceRows[i], sliceRows[i + 1]) 行
+    int chromaShift = 0;
+    bool rgbPlanes = false;
+
+    ~ConvertPlan();
+    int getSliceCount() const;
+    const char* getKernelName() const;
+};
+
+class SwsCache {
+public:
+    explicit SwsCache(size_t capacity = 4);
+    ~SwsCache();
+
+    // 命中时移到最近使用位置；未命中时创建，超出容量淘汰最久未用的一项
+    // 返回的指针在下一次 acquire 之前有效
+    ConvertPlan* acquire(const ConvertKey& key, int maxSlices);
+
+    int64_t getHits() const;
+    int64_t getMisses() const;
+
+private:
+    static ConvertPlan* createPlan(const ConvertKey& key, int maxSlices);
+
+    std::list<ConvertPlan*> entries;  // 头部为最近使用
+    size_t capacity;
+    int64_t hits = 0;
+    int64_t misses = 0;
+};
+
+
+#endif //ANDROIDPLAYER_SWSCACHE_H
@@ -0,0 +1,95 @@
+//
+// taskScheduler.h
+// 进程内所有播放器共享的任务调度器：工作线程数等于核数，每个线程一个任务队列，自己从尾部取，空闲时从别人头部偷。
+// 流水线阶段写成 Task，每次 step 只做一小步，等输入、输出空间或跳转时返回 Blocked，由对方 wake 后再调度
+//
+
+#ifndef ANDROIDPLAYER_TASKSCHEDULER_H
+#define ANDROIDPLAYER_TASKSCHEDULER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+class Task : public std::enable_shared_from_this<Task> {
+public:
+    enum class Status {
+        Yield,    // 还有工作，排到队尾让别的任务先跑
+        Blocked,  // 等 wake（或 wakeAfter 到期）
+        Done,     // 结束，之后的 wake 被忽略
+    };
+
+    virtual ~Task() = default;
+
+    // 在调度器线程上执行一步，不要在里面长时间阻塞
+    virtual Status step() = 0;
+
+    // 任意线程都可以调用；正在执行时调用会在这一步结束后再执行一次，不会丢失
+    void wake();
+    // seconds 秒后 wake，用于等主时钟
+    void wakeAfter(double seconds);
+    // 等 step 返回 Done
+    void join();
+
+private:
+    friend class TaskScheduler;
+
+    enum State { Idle, Queued, Running, Notified, Finished };
+    std::atomic<int> state{Idle};
+    std::mutex doneMtx;
+    std::condition_variable doneCond;
+};
+
+class TaskScheduler {
+public:
+    static TaskScheduler& instance();
+    int size() const;
+
+private:
+    friend class Task;
+    using Clock = std::chrono::steady_clock;
+
+    explicit TaskScheduler(int threadCount);
+    ~TaskScheduler();
+
+    void submit(std::shared_ptr<Task> task);
+    void submitAfter(std::shared_ptr<Task> task, double seconds);
+    void run(const std::shared_ptr<Task>& task);
+    std::shared_ptr<Task> take(int self);
+    void workerLoop(int self);
+    void timerLoop();
+
+    struct Worker {
+        std::mutex mtx;
+        std::deque<std::shared_ptr<Task>> tasks;
+    };
+
+    struct Timed {
+        Clock::time_point due;
+        std::shared_ptr<Task> task;
+        bool operator>(const Timed& other) const { return due > other.due; }
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::vector<std::thread> threads;
+    std::atomic<unsigned> nextWorker{0};  // 非工作线程提交时轮流放入
+    std::atomic<int> pending{0};          // 所有队列里的任务数
+
+    std::mutex idleMtx;
+    std::condition_variable idleCond;
+    bool stopping = false;
+
+    std::mutex timerMtx;
+    std::condition_variable timerCond;
+    std::priority_queue<Timed, std::vector<Timed>, std::greater<Timed>> timers;
+    std::thread timerThread;
+};
+
+
+#endif //ANDROIDPLAYER_TASKSCHEDULER_H
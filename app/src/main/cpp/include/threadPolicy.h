@@ -0,0 +1,34 @@
+//
+// threadPolicy.h
+// 根据分辨率、profile 和 CPU 大小核拓扑选择解码线程类型和数量
+//
+
+#ifndef ANDROIDPLAYER_THREADPOLICY_H
+#define ANDROIDPLAYER_THREADPOLICY_H
+
+extern "C" {
+#include "libavcodec/avcodec.h"
+}
+
+struct CpuTopology {
+    int totalCores = 0;
+    int bigCores = 0;     // 最高频率簇（含中核）
+    int littleCores = 0;  // 最低频率簇
+};
+
+struct ThreadDecision {
+    int threadType = 0;   // FF_THREAD_FRAME / FF_THREAD_SLICE
+    int threadCount = 1;
+};
+
+// 读取 /sys/devices/system/cpu 下各核心的最高频率并划分大小核，结果只读取一次
+const CpuTopology& getCpuTopology();
+
+// lowLatency: 直播或低延迟模式，优先使用不增加解码延迟的 slice 线程
+ThreadDecision chooseDecodeThreading(const AVCodec* codec, const AVCodecParameters* codecpar,
+                                     bool lowLatency);
+
+// 必须在 avcodec_open2 之前调用
+void applyDecodeThreading(AVCodecContext* codecCtx, const ThreadDecision& decision);
+
+#endif //ANDROIDPLAYER_THREADPOLICY_H
@@ -0,0 +1,53 @@
+//
+// yuvConverter.h
+// 同尺寸 YUV420 (yuv420p/nv12/nv21) -> RGBA/RGB565 的 SIMD 转换，替代通用 sws_scale
+//
+
+#ifndef ANDROIDPLAYER_YUVCONVERTER_H
+#define ANDROIDPLAYER_YUVCONVERTER_H
+
+extern "C" {
+#include "libavutil/frame.h"
+#include "libavutil/pixfmt.h"
+#include "libavutil/pixdesc.h"
+}
+
+#include <cstdint>
+
+// Q6 定点系数
+struct YuvCoeffs {
+    int16_t yOffset;
+    int16_t yMul;
+    int16_t vr;
+    int16_t ug;
+    int16_t vg;
+    int16_t ub;
+};
+
+class YuvConverter {
+public:
+    enum Layout { LAYOUT_I420, LAYOUT_NV12, LAYOUT_NV21 };
+
+    // 不支持的组合返回 false，调用方应回退到 sws_scale
+    static bool isSupported(AVPixelFormat src, AVPixelFormat dst);
+
+    // colorspace 未指定时按宽度推断：高清用 BT.709，标清用 BT.601；simd 为 false 时固定用标量内核（测试对照）
+    bool init(AVPixelFormat src, AVPixelFormat dst, AVColorSpace colorspace, AVColorRange range, int width,
+              bool simd = true);
+
+    // 只转换 [rowStart, rowEnd) 行，方便按行分片并行
+    void convert(const AVFrame* src, AVFrame* dst, int rowStart, int rowEnd) const;
+
+    const char* getKernelName() const;
+
+private:
+    typedef void (*RowFunc)(const uint8_t* y, const uint8_t* u, const uint8_t* v, uint8_t* dst,
+                            int width, Layout layout, const YuvCoeffs* c);
+
+    Layout layout = LAYOUT_I420;
+    YuvCoeffs coeffs = {};
+    RowFunc rowFunc = nullptr;
+    const char* kernelName = "none";
+};
+
+#endif //ANDROIDPLAYER_YUVCONVERTER_H
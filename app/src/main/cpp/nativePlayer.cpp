@@ -0,0 +1,496 @@
+//
+// nativePlayer.cpp
+//
+
+#include "nativePlayer.h"
+#include "log.h"
+#define TAG "nativePlayer"
+
+#include <cmath>
+#include <algorithm>
+#include <chrono>
+
+static const size_t frameQueueDepth = 6; // 解码领先渲染的最大帧数
+static const size_t frameCacheBytes = 64 << 20; // 已解码帧缓存的内存预算，1080p 约 20 帧
+static const size_t audioRingBytes = 9600000;
+static const size_t audioRingAhead = 44100 * 4; // 音频解码领先播放约 1 秒就停下（44.1kHz 立体声 S16）
+static const double seekHintTtl = 5.0; // 提示多久没用到就丢弃（秒）
+
+extern std::shared_ptr<Task> createDemuxTask(AVFormatContext* formatCtx, PacketQueue* videoQueue, PacketQueue* audioQueue, int videoStreamIndex, int audioStreamIndex, PlaybackControl* control, Timer* timer, PlayerStats* stats);
+extern void decodeThread(PacketQueue* packetQueue, FrameQueue* frameQueue, AVCodecParameters* codecpar, AVRational timeBase, bool lowLatency, const SurfaceSize* surfaceSize, PlaybackControl* control, Timer* timer, PlayerStats* stats, FrameCache* frameCache, SpeculativeDecoder* speculative, const char* path, StandbyEntry* standby);
+extern void renderThread(FrameQueue* frameQueue, SurfaceSlot* surfaceSlot, const AVRational* timeBase, SurfaceSize* surfaceSize, PlaybackControl* control, Timer* timer, PlayerStats* stats);
+extern std::shared_ptr<Task> createAudioDecodeTask(PacketQueue* packetQueue, AudioRingBuffer* ringBuffer, size_t ringAhead, AVCodecParameters* codecpar, AVRational timeBase, PlaybackControl* control, Timer* timer, PlayerStats* stats, StandbyEntry* standby);
+extern void AAudioPlayerThread(AudioRingBuffer* ringBuffer, PlaybackControl* control, Timer* timer, PlayerStats* stats);
+
+// 队列和跳转回调只持有弱引用，任务结束释放后回调什么也不做
+static std::function<void()> waker(const std::shared_ptr<Task>& task) {
+    std::weak_ptr<Task> weak = task;
+    return [weak]() {
+        if (auto task = weak.lock()) task->wake();
+    };
+}
+
+// 直播流没有时长，解码应尽量低延迟
+static bool isLiveSource(AVFormatContext* ctx, const std::string& path) {
+    if (ctx->duration == AV_NOPTS_VALUE) return true;
+    return path.rfind("rtsp:", 0) == 0 || path.rfind("rtmp:", 0) == 0 || path.rfind("udp:", 0) == 0;
+}
+
+NativePlayer::NativePlayer() : frameCache(frameCacheBytes), speculative(&stats) {}
+
+NativePlayer::~NativePlayer() {
+    stop();
+}
+
+// 视频一帧的时长（秒），缓存里找不到相邻帧时用来估算步进目标
+double NativePlayer::frameDuration() const {
+    AVRational rate = formatCtx->streams[videoStreamIndex]->avg_frame_rate;
+    if (rate.num <= 0 || rate.den <= 0) rate = formatCtx->streams[videoStreamIndex]->r_frame_rate;
+    return rate.num > 0 && rate.den > 0 ? av_q2d(av_inv_q(rate)) : 1.0 / 25;
+}
+
+// A-B 循环时时间戳每一遍整体后移，把主时钟换算回区间内的位置；倒放不循环，时间戳不偏移
+double NativePlayer::toLoopPosition(double time) const {
+    double loopStart, loopEnd;
+    if (control.getDirection() < 0 || !control.getLoop(loopStart, loopEnd)) return time;
+    if (time < loopStart) return loopStart;
+    return loopStart + fmod(time - loopStart, loopEnd - loopStart);
+}
+
+// 所有线程按新序号丢弃旧数据；清空 frameQueue 以唤醒阻塞在 push 上的解码线程
+void NativePlayer::seekTo(double target, int direction) {
+    if (direction > 0) target = toLoopPosition(target);
+    if (target < 0) target = 0;
+    timer.seekTo(target);
+    control.requestSeek(target, direction);
+    frameQueue->clear();
+}
+
+int NativePlayer::prepare(const char* path, ANativeWindow* window, std::function<void(int)> callback) {
+    if (isInited || prepareThread.joinable()) {
+        ANativeWindow_release(window);
+        return -1;
+    }
+
+    videoPath = path;
+    LOGI("📁 nativeSetDataSource: %s", videoPath.c_str());
+
+    // 设置 surface
+    if (nativeWindow) {
+        ANativeWindow_release(nativeWindow);
+    }
+    nativeWindow = window;
+
+    surfaceSize.set(ANativeWindow_getWidth(nativeWindow), ANativeWindow_getHeight(nativeWindow));
+    surfaceSize.attached = true;
+    surfaceSlot.set(nativeWindow);
+    LOGI("✅ nativeSetSurface success: window=%p size=%dx%d", nativeWindow,
+         surfaceSize.width.load(), surfaceSize.height.load());
+
+    LOGI("▶️ nativePrepare");
+
+    // 初始化全局状态
+    avformat_network_init();
+    // 倍速是播放器的设置，prepare 之前设置的保留；倒放要从已有的位置开始，新的播放总是正放
+    double speed = control.getSpeed();
+    if (speed <= 0) speed = 1.0;
+    control.reset();
+    control.setSpeed(speed);
+    stats.reset();
+
+    // start 之前整条流水线保持暂停：队列填到水位，渲染和音频输出停在第一帧、第一段音频
+    timer.setCurrentTime(0); // 设置初始时间为 0
+    timer.setTimeSpeed(speed);
+    timer.start();
+    timer.pause();
+    control.setPaused(true);
+
+    onPrepared = std::move(callback);
+    // 渲染（第一帧已上传）和音频输出（第一段已写入设备）都就绪后报告 prepare 完成
+    control.beginPreroll(2, [this]() {
+        stats.markPrepared();
+        LOGI("✅ Prepared in %.1f ms", stats.prepareUs.load() / 1000.0);
+        if (onPrepared) onPrepared(0);
+    });
+
+    packetQueue = new PacketQueue();        // video
+    audioPacketQueue = new PacketQueue();   // ✅ audio
+    frameQueue = new FrameQueue(frameQueueDepth);
+    audioRingBuffer = new AudioRingBuffer(audioRingBytes);
+
+    // 换 Surface 时渲染线程可能阻塞在 frameQueue 或暂停中
+    surfaceSlot.setWaker([this]() {
+        frameQueue->interrupt();
+        control.signalSurface();
+    });
+
+    // 渲染线程先启动，EGL 上下文和着色器程序与打开、探测文件并行准备
+    rendererThread = std::thread(renderThread, frameQueue, &surfaceSlot, &videoTimeBase, &surfaceSize, &control,
+                                 &timer, &stats);
+    prepareThread = std::thread(&NativePlayer::runPrepare, this);
+    return 0;
+}
+
+// 打开和探测可能要几百毫秒（网络源更久），不占用调用 prepare 的 Java 线程
+void NativePlayer::runPrepare() {
+    auto fail = [this](int code) {
+        if (onPrepared && !control.isStopped()) onPrepared(code);
+    };
+
+    StandbyCache& cache = StandbyCache::instance();
+    standby = cache.take(videoPath);
+    if (standby) {
+        // 热备缓存命中：已经探测过的输入回到开头，上次丢弃的视频流恢复
+        stats.standbyState = 2;
+        standby->bind(control.cancelToken());
+        std::swap(formatCtx, standby->formatCtx);
+        for (unsigned int i = 0; i < formatCtx->nb_streams; i++) {
+            formatCtx->streams[i]->discard = AVDISCARD_DEFAULT;
+        }
+        if (avformat_seek_file(formatCtx, -1, INT64_MIN, 0, 0, 0) < 0) {
+            LOGE("❌ Failed to rewind standby input.");
+            return fail(-1);
+        }
+    } else {
+        if (cache.enabled()) {
+            stats.standbyState = 1;
+            standby.reset(new StandbyEntry());
+            standby->path = videoPath;
+            // 只缓存能按大小和修改时间认出来的本地文件
+            if (standby->stampFile()) {
+                standby->bind(control.cancelToken());
+            } else {
+                standby.reset();
+            }
+        }
+
+        // 打开视频获取 AVFormatContext；stop 可以打断网络源的打开和读取
+        formatCtx = avformat_alloc_context();
+        formatCtx->interrupt_callback = standby ? standby->interruptCallback()
+                                                : control.cancelToken()->interruptCallback();
+        if (avformat_open_input(&formatCtx, videoPath.c_str(), nullptr, nullptr) != 0) {
+            LOGE("❌ Failed to open input file.");
+            return fail(-1);
+        }
+
+        if (avformat_find_stream_info(formatCtx, nullptr) < 0) {
+            LOGE("❌ Failed to find stream info.");
+            return fail(-2);
+        }
+    }
+
+    // 找到视频流和音频流索引
+    for (unsigned int i = 0; i < formatCtx->nb_streams; i++) {
+        if (formatCtx->streams[i]->codecpar->codec_type == AVMEDIA_TYPE_VIDEO) {
+            videoStreamIndex = i;
+            videoTimeBase = formatCtx->streams[i]->time_base;
+            LOGI("🎥 Video stream index: %d", videoStreamIndex);
+        }
+        if (formatCtx->streams[i]->codecpar->codec_type == AVMEDIA_TYPE_AUDIO){
+            audioStreamIndex = i;
+            LOGI("🎵 Audio stream index: %d", audioStreamIndex);
+        }
+    }
+
+    if (videoStreamIndex == -1) {
+        LOGE("❌ No video stream found.");
+        return fail(-3);
+    }
+
+    if (audioStreamIndex == -1) {
+        LOGE("❌ No audio stream found.");
+        return fail(-4);
+    }
+
+    if (control.isStopped()) return;
+
+    LOGI("📦 Starting demux/decode/audio threads...");
+    frameCache.clear();
+
+    demuxTask = createDemuxTask(formatCtx, packetQueue, audioPacketQueue, videoStreamIndex, audioStreamIndex,
+                                &control, &timer, &stats);
+    audioDecodeTask = createAudioDecodeTask(audioPacketQueue, audioRingBuffer, audioRingAhead,
+                                formatCtx->streams[audioStreamIndex]->codecpar,
+                                formatCtx->streams[audioStreamIndex]->time_base, &control, &timer, &stats,
+                                standby.get());
+    // 解复用等队列空间、跳转和恢复播放，音频解码等新包和环形缓冲区降到水位
+    packetQueue->setPopListener(waker(demuxTask));
+    audioPacketQueue->setPopListener(waker(demuxTask));
+    demuxListener = control.addListener(waker(demuxTask));
+    audioPacketQueue->setPushListener(waker(audioDecodeTask));
+    audioRingBuffer->setLowWaterListener(audioRingAhead, waker(audioDecodeTask));
+    decoderThread = std::thread(decodeThread, packetQueue, frameQueue,
+                                formatCtx->streams[videoStreamIndex]->codecpar, videoTimeBase,
+                                isLiveSource(formatCtx, videoPath), &surfaceSize, &control, &timer, &stats,
+                                &frameCache, &speculative, videoPath.c_str(), standby.get());
+    aAudioPlayerThread = std::thread(AAudioPlayerThread, audioRingBuffer, &control, &timer, &stats);
+    demuxTask->wake();
+    audioDecodeTask->wake();
+
+    isInited = true;
+}
+
+// 恢复预滚动时停住的流水线；首帧耗时从这里开始计
+int NativePlayer::start() {
+    if (!isInited && !prepareThread.joinable()) return -1;
+    if (stats.startRequestUs.load() == 0) stats.markStart();
+    pause(false);
+    LOGI("⏱️ Started at %.3f", timer.getCurrentTime());
+    return 0;
+}
+
+int NativePlayer::stop() {
+    LOGI("🛑 nativeStop called");
+    auto stopStart = std::chrono::steady_clock::now();
+
+    // 停止主时钟
+    timer.pause();
+
+    // 取消 token 打断睡眠、倒放批次等待和 FFmpeg 读取，结束队列唤醒阻塞的 pop/push；
+    // 等线程和任务都退出后再释放它们用到的队列和 codecpar
+    control.stop();
+    if (prepareThread.joinable()) prepareThread.join();
+    if (frameQueue) frameQueue->setFinished(true);
+    if (packetQueue) packetQueue->setFinished(true);
+    if (audioPacketQueue) audioPacketQueue->setFinished(true);
+    if (audioRingBuffer) audioRingBuffer->setFinished(true);
+    for (std::thread* t : {&decoderThread, &rendererThread, &aAudioPlayerThread}) {
+        if (t->joinable()) t->join();
+    }
+    for (std::shared_ptr<Task>* task : {&demuxTask, &audioDecodeTask}) {
+        if (*task) (*task)->join();
+        task->reset();
+    }
+    control.removeListener(demuxListener);
+    demuxListener = -1;
+    timer.stop();
+    timer.setCurrentTime(0);
+    frameCache.clear();
+
+    // 释放 native window
+    surfaceSlot.setWaker(nullptr);
+    surfaceSlot.set(nullptr);
+    if (nativeWindow) {
+        ANativeWindow_release(nativeWindow);
+        nativeWindow = nullptr;
+        LOGI("🧹 Released ANativeWindow");
+    }
+
+    // 本地文件放回热备缓存，下次播放同一个文件跳过打开、探测和解码器初始化；
+    // 被打断的读取会在 AVIOContext 上留下错误，这样的输入不留
+    if (standby && formatCtx && isInited && !isLiveSource(formatCtx, videoPath) &&
+        !(formatCtx->pb && formatCtx->pb->error < 0)) {
+        standby->bind(nullptr);
+        std::swap(formatCtx, standby->formatCtx);
+        StandbyCache::instance().put(std::move(standby));
+    }
+
+    // 关闭并释放 AVFormatContext；interrupt_callback 可能指向热备条目，先关闭再释放条目
+    if (formatCtx) {
+        avformat_close_input(&formatCtx);  // 自动释放 streams
+        formatCtx = nullptr;
+        LOGI("🧹 Closed AVFormatContext");
+    }
+    standby.reset();
+
+    // 释放 PacketQueue（video）
+    if (packetQueue) {
+        delete packetQueue;
+        packetQueue = nullptr;
+        LOGI("🧹 Deleted video PacketQueue");
+    }
+
+    // 释放 PacketQueue（audio）
+    if (audioPacketQueue) {
+        delete audioPacketQueue;
+        audioPacketQueue = nullptr;
+        LOGI("🧹 Deleted audio PacketQueue");
+    }
+
+    // 释放 FrameQueue
+    if (frameQueue) {
+        delete frameQueue;
+        frameQueue = nullptr;
+        LOGI("🧹 Deleted FrameQueue");
+    }
+
+    // 释放 AudioRingBuffer，下次播放重新分配
+    if (audioRingBuffer) {
+        delete audioRingBuffer;
+        audioRingBuffer = nullptr;
+        LOGI("🧹 Deleted AudioRingBuffer");
+    }
+
+    // 清空视频路径和流索引
+    videoPath.clear();
+    videoStreamIndex = -1;
+    audioStreamIndex = -1;
+
+    isInited = false;
+    onPrepared = nullptr;
+
+    LOGI("✅ All playback resources cleaned up in %.1f ms",
+         std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - stopStart).count());
+    return 0;
+}
+
+// 主时钟和整条流水线一起暂停/恢复
+void NativePlayer::pause(bool paused) {
+    if (paused) {
+        timer.pause();
+    } else {
+        timer.resume();
+    }
+    control.setPaused(paused);
+}
+
+void NativePlayer::setSurface(ANativeWindow* window) {
+    if (window) {
+        surfaceSize.set(ANativeWindow_getWidth(window), ANativeWindow_getHeight(window));
+    } else {
+        stats.surfaceDetaches++;
+    }
+    surfaceSize.attached = window != nullptr;
+    // 渲染线程换好之后旧窗口才能释放
+    surfaceSlot.set(window);
+    if (nativeWindow) ANativeWindow_release(nativeWindow);
+    nativeWindow = window;
+    LOGI("🔌 setSurface: window=%p", window);
+}
+
+int NativePlayer::setAudioOnly(bool audioOnly) {
+    // 预滚动要等第一帧视频，就绪之后才能切换
+    if (!isInited || control.isPrerolling()) return -1;
+    if (control.isAudioOnly() == audioOnly) return 0;
+    stats.markAudioOnly(audioOnly);
+    control.setAudioOnly(audioOnly);
+    if (audioOnly) {
+        // 已经排队的包和帧也不再解码和显示，两个线程阻塞在空队列上
+        packetQueue->clear();
+        frameQueue->clear();
+        LOGI("🎧 Audio only");
+        return 0;
+    }
+    // 视频从当前位置之前的关键帧重新解码；暂停、倍速和方向保持不变
+    seekTo(timer.getCurrentTime(), control.getDirection());
+    LOGI("🎬 Video resumed at %.3f", timer.getCurrentTime());
+    return 0;
+}
+
+int NativePlayer::seek(double position) {
+    if (!isInited) return -1;
+    if (control.isScrubbing()) stats.scrubRequests++;
+    seekTo(position, control.getDirection());
+    return 0;
+}
+
+// 提示一个可能的跳转目标（章节点、快进/快退按钮），真正跳转前在后台预解码
+void NativePlayer::hintSeek(double position) {
+    if (!isInited) return;
+    speculative.hint(toLoopPosition(std::max(0.0, position)), seekHintTtl);
+}
+
+// 开始拖动：暂停主时钟，之后的 seek 只更新目标，各线程只处理最新的一个
+void NativePlayer::beginScrub() {
+    if (!isInited || control.isScrubbing()) return;
+    resumeAfterScrub = !control.isPaused();
+    pause(true);
+    control.setScrubbing(true);
+}
+
+// 松手：做一次精确跳转，恢复拖动前的播放状态
+int NativePlayer::endScrub(double position) {
+    if (!isInited) return -1;
+    control.setScrubbing(false);
+    seekTo(position, control.getDirection());
+    if (resumeAfterScrub) pause(false);
+    resumeAfterScrub = false;
+    return 0;
+}
+
+// 暂停并前进一帧：下一帧通常已在 frameQueue 中，只需把主时钟移到它的时间
+int NativePlayer::stepForward() {
+    if (!isInited) return -1;
+    pause(true);
+    int64_t displayed = control.getDisplayedPts();
+    if (displayed == AV_NOPTS_VALUE) return -1;
+
+    int64_t next = frameCache.findNext(displayed);
+    double target = next != AV_NOPTS_VALUE ? next * av_q2d(videoTimeBase)
+                                           : displayed * av_q2d(videoTimeBase) + frameDuration();
+    timer.seekTo(target);
+    control.nudge();
+    return 0;
+}
+
+// 暂停并后退一帧：上一帧在缓存中时立即显示，否则从它所在 GOP 的关键帧解码过去
+int NativePlayer::stepBackward() {
+    if (!isInited) return -1;
+    pause(true);
+    int64_t displayed = control.getDisplayedPts();
+    if (displayed == AV_NOPTS_VALUE) return -1;
+
+    // 跳到上一帧和当前帧之间，覆盖这个时间的正好是上一帧
+    int64_t prev = frameCache.findPrev(displayed);
+    double target = prev != AV_NOPTS_VALUE ? (prev + displayed) / 2.0 * av_q2d(videoTimeBase)
+                                           : displayed * av_q2d(videoTimeBase) - frameDuration() / 2;
+    seekTo(target, control.getDirection());
+    return 0;
+}
+
+int NativePlayer::setSpeed(float speed) {
+    if (speed == 0) return -1;
+    // 还没有播放位置可以倒放，拒绝而不是在 prepare 时悄悄丢掉
+    if (speed < 0 && !isInited) return -1;
+    int direction = speed < 0 ? -1 : 1;
+    TrickMode oldMode = control.getTrickMode();
+    timer.setTimeSpeed(speed);
+    control.setSpeed(speed);
+    control.nudge();  // 主时钟的速率变了，等显示时间的线程重新计算
+
+    // 正放/倒放切换，或进出只读关键帧的高倍速：从当前显示的帧开始重建流水线
+    // 丢弃非参考帧只是解码器参数，解码线程下一个包就切换，不需要跳转
+    bool keyframesChanged = (oldMode == TrickMode::Keyframes) != (control.getTrickMode() == TrickMode::Keyframes);
+    if (isInited && (direction != control.getDirection() || keyframesChanged)) {
+        int64_t displayed = control.getDisplayedPts();
+        double position = displayed != AV_NOPTS_VALUE ? displayed * av_q2d(videoTimeBase) : timer.getCurrentTime();
+        seekTo(position, direction);
+    }
+    return 0;
+}
+
+// A-B 循环（单位：秒），end <= start 时关闭；从当前位置重新读，之后每一遍无缝回绕。
+// 播放方向不变：倒放时区间先记下，切回正放后生效
+int NativePlayer::setLoop(double start, double end) {
+    if (!isInited) return -1;
+    double position = toLoopPosition(timer.getCurrentTime());
+    control.setLoop(start, end);
+    seekTo(position, control.getDirection());
+    return 0;
+}
+
+// 屏幕刷新率，内容帧率更高时解码线程抽帧；播放前后都可以设置
+void NativePlayer::setRefreshRate(float hz) {
+    if (hz > 0) surfaceSize.refreshRate = hz;
+}
+
+double NativePlayer::getPosition() const {
+    return toLoopPosition(timer.getCurrentTime());
+}
+
+double NativePlayer::getDuration() const {
+    if (!isInited) {
+        LOGE("❌ Not prepared, cannot get duration");
+        return -1; // 错误处理：返回 -1 表示无法获取时长
+    }
+
+    // 获取视频时长（单位：微秒），并转换为秒
+    double durationInSeconds = formatCtx->duration / (double) AV_TIME_BASE;
+    LOGI("⏳ Video duration: %.3f seconds", durationInSeconds);
+
+    return durationInSeconds;
+}
+
+std::string NativePlayer::getStats() const {
+    return stats.toString();
+}
@@ -11,36 +11,74 @@ PacketQueue::~PacketQueue() {
     clear();
 }
 
+void PacketQueue::notify(const std::function<void()>& listener) {
+    if (listener) listener();
+}
+
 void PacketQueue::push(AVPacket *pkt) {
-    std::unique_lock<std::mutex> lock(mtx);
-    queue.push(pkt);
-    cv.notify_one();
+    {
+        std::unique_lock<std::mutex> lock(mtx);
+        queue.push(pkt);
+        cv.notify_one();
+    }
+    notify(onPush);
 }
 
 AVPacket* PacketQueue::pop() {
-    std::unique_lock<std::mutex> lock(mtx);
-    cv.wait(lock, [this] { return !queue.empty() || finished; });
+    AVPacket *pkt;
+    {
+        std::unique_lock<std::mutex> lock(mtx);
+        cv.wait(lock, [this] { return !queue.empty() || finished; });
 
-    if (queue.empty()) return nullptr;
+        if (queue.empty()) return nullptr;
 
-    AVPacket *pkt = queue.front();
-    queue.pop();
+        pkt = queue.front();
+        queue.pop();
+    }
+    notify(onPop);
     return pkt;
 }
 
-void PacketQueue::clear() {
-    std::unique_lock<std::mutex> lock(mtx);
-    while (!queue.empty()) {
-        AVPacket *pkt = queue.front();
-        av_packet_free(&pkt);
+AVPacket* PacketQueue::tryPop() {
+    AVPacket *pkt;
+    {
+        std::unique_lock<std::mutex> lock(mtx);
+        if (queue.empty()) return nullptr;
+        pkt = queue.front();
         queue.pop();
     }
+    notify(onPop);
+    return pkt;
+}
+
+void PacketQueue::clear() {
+    {
+        std::unique_lock<std::mutex> lock(mtx);
+        while (!queue.empty()) {
+            AVPacket *pkt = queue.front();
+            av_packet_free(&pkt);
+            queue.pop();
+        }
+    }
+    notify(onPop);
 }
 
 void PacketQueue::setFinished(bool isFinished) {
-    std::unique_lock<std::mutex> lock(mtx);
-    finished = isFinished;
-    cv.notify_all();
+    {
+        std::unique_lock<std::mutex> lock(mtx);
+        finished = isFinished;
+        cv.notify_all();
+    }
+    notify(onPush);
+    notify(onPop);
+}
+
+void PacketQueue::setPushListener(std::function<void()> listener) {
+    onPush = std::move(listener);
+}
+
+void PacketQueue::setPopListener(std::function<void()> listener) {
+    onPop = std::move(listener);
 }
 
 bool PacketQueue::isFinished() const {
@@ -52,3 +90,8 @@ bool PacketQueue::empty() const {
     std::unique_lock<std::mutex> lock(mtx);
     return queue.empty();
 }
+
+size_t PacketQueue::size() const {
+    std::unique_lock<std::mutex> lock(mtx);
+    return queue.size();
+}
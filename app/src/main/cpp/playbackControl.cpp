@@ -0,0 +1,223 @@
+//
+// playbackControl.cpp
+//
+
+#include "playbackControl.h"
+
+extern "C" {
+#include <libavutil/avutil.h>
+}
+
+void PlaybackControl::reset() {
+    std::lock_guard<std::mutex> lock(mtx);
+    serial = 0;
+    seekTarget = 0.0;
+    direction = 1;
+    loopStart = loopEnd = 0.0;
+    scrubbing = false;
+    speed = 1.0;
+    token.reset();
+    paused = false;
+    audioOnly = false;
+    surfacePending = false;
+    prerollStages = 0;
+    prerollReady = nullptr;
+    displayedPts = AV_NOPTS_VALUE;
+}
+
+int PlaybackControl::requestSeek(double target, int newDirection) {
+    int newSerial;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        seekTarget = target;
+        direction = newDirection < 0 ? -1 : 1;
+        newSerial = ++serial;
+        cv.notify_all();
+    }
+    notifyListeners();
+    return newSerial;
+}
+
+int PlaybackControl::getSerial() const {
+    return serial.load();
+}
+
+void PlaybackControl::getSeek(int& outSerial, double& outTarget) const {
+    std::lock_guard<std::mutex> lock(mtx);
+    outSerial = serial;
+    outTarget = seekTarget;
+}
+
+int PlaybackControl::getDirection() const {
+    return direction.load();
+}
+
+void PlaybackControl::setLoop(double start, double end) {
+    std::lock_guard<std::mutex> lock(mtx);
+    loopStart = start;
+    loopEnd = end;
+}
+
+bool PlaybackControl::getLoop(double& start, double& end) const {
+    std::lock_guard<std::mutex> lock(mtx);
+    start = loopStart;
+    end = loopEnd;
+    return loopEnd > loopStart;
+}
+
+void PlaybackControl::setScrubbing(bool value) {
+    scrubbing = value;
+}
+
+bool PlaybackControl::isScrubbing() const {
+    return scrubbing.load();
+}
+
+void PlaybackControl::setSpeed(double value) {
+    speed = value;
+}
+
+double PlaybackControl::getSpeed() const {
+    return speed.load();
+}
+
+TrickMode PlaybackControl::getTrickMode() const {
+    // 倒放由 ReverseDecoder 按 GOP 解码，不走这里
+    double s = speed.load();
+    if (s > 4.0) return TrickMode::Keyframes;
+    if (s > 2.0) return TrickMode::NonRef;
+    return TrickMode::None;
+}
+
+void PlaybackControl::setAudioOnly(bool value) {
+    if (audioOnly.exchange(value) == value) return;
+    notifyListeners();
+}
+
+bool PlaybackControl::isAudioOnly() const {
+    return audioOnly.load();
+}
+
+void PlaybackControl::setPaused(bool value) {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (paused == value) return;
+        paused = value;
+        cv.notify_all();
+    }
+    notifyListeners();
+}
+
+bool PlaybackControl::isPaused() const {
+    return paused.load();
+}
+
+void PlaybackControl::nudge() {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        clockEpoch++;
+        cv.notify_all();
+    }
+    notifyListeners();
+}
+
+void PlaybackControl::signalSurface() {
+    std::lock_guard<std::mutex> lock(mtx);
+    surfacePending = true;
+    cv.notify_all();
+}
+
+bool PlaybackControl::takeSurfaceSignal() {
+    std::lock_guard<std::mutex> lock(mtx);
+    bool pending = surfacePending;
+    surfacePending = false;
+    return pending;
+}
+
+bool PlaybackControl::waitUntilResumed() {
+    std::unique_lock<std::mutex> lock(mtx);
+    cv.wait(lock, [&] { return !paused || token.isCancelled(); });
+    return !token.isCancelled();
+}
+
+bool PlaybackControl::waitWhilePaused(int oldSerial) {
+    std::unique_lock<std::mutex> lock(mtx);
+    int epoch = clockEpoch;
+    cv.wait(lock, [&] { return !paused || clockEpoch != epoch || surfacePending || serial != oldSerial ||
+                             token.isCancelled(); });
+    return serial == oldSerial && !token.isCancelled();
+}
+
+void PlaybackControl::beginPreroll(int stages, std::function<void()> onReady) {
+    std::lock_guard<std::mutex> lock(mtx);
+    prerollStages = stages;
+    prerollReady = std::move(onReady);
+}
+
+void PlaybackControl::prerollDone() {
+    std::function<void()> ready;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (prerollStages == 0 || --prerollStages > 0) return;
+        ready = std::move(prerollReady);
+        prerollReady = nullptr;
+    }
+    if (ready && !token.isCancelled()) ready();
+}
+
+bool PlaybackControl::isPrerolling() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return prerollStages > 0;
+}
+
+int PlaybackControl::addListener(std::function<void()> listener) {
+    std::lock_guard<std::mutex> lock(listenerMtx);
+    listeners[nextListenerId] = std::move(listener);
+    return nextListenerId++;
+}
+
+void PlaybackControl::removeListener(int id) {
+    std::lock_guard<std::mutex> lock(listenerMtx);
+    listeners.erase(id);
+}
+
+void PlaybackControl::notifyListeners() {
+    std::lock_guard<std::mutex> lock(listenerMtx);
+    for (auto& entry : listeners) entry.second();
+}
+
+void PlaybackControl::stop() {
+    token.cancel();
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        cv.notify_all();
+    }
+    notifyListeners();
+}
+
+bool PlaybackControl::isStopped() const {
+    return token.isCancelled();
+}
+
+CancelToken* PlaybackControl::cancelToken() {
+    return &token;
+}
+
+bool PlaybackControl::sleepFor(double seconds, int oldSerial) {
+    std::unique_lock<std::mutex> lock(mtx);
+    int epoch = clockEpoch;
+    bool wasPaused = paused;
+    cv.wait_for(lock, std::chrono::microseconds((int64_t) (seconds * 1e6)), [&] {
+        return serial != oldSerial || token.isCancelled() || clockEpoch != epoch || paused != wasPaused ||
+               surfacePending;
+    });
+    return serial == oldSerial && !token.isCancelled();
+}
+
+void PlaybackControl::setDisplayedPts(int64_t pts) {
+    displayedPts = pts;
+}
+
+int64_t PlaybackControl::getDisplayedPts() const {
+    return displayedPts.load();
+}
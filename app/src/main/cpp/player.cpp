@@ -1,263 +1,254 @@
 //
 // player.cpp
 // Created by zylnt on 2025/3/30.
+// JNI 入口：每个 Java Player 对应一个 NativePlayer，指针保存在 Player.nativeContext 中
 //
 
 #include <jni.h>
-#include <string>
-#include <thread>
 #include "log.h"
 #define TAG "player"
-#include "packetQueue.h"
-#include "frameQueue.h"
-#include "audioRingBuffer.h"
-#include "timer.h"
+#include "nativePlayer.h"
+#include "programCache.h"
+#include "standbyCache.h"
 
 extern "C" {
-#include <libavformat/avformat.h>
 #include <android/native_window_jni.h>
 }
 
-// 全局资源
-static PacketQueue* packetQueue = nullptr;
-static FrameQueue* frameQueue = nullptr;
-static AVFormatContext* formatCtx = nullptr;
-static int videoStreamIndex = -1;
-static int audioStreamIndex = -1;
-static AVRational videoTimeBase;
-static ANativeWindow* nativeWindow = nullptr;
-static std::string videoPath;
-static PacketQueue* audioPacketQueue = nullptr;
-static AudioRingBuffer* audioRingBuffer = new AudioRingBuffer(9600000);
-static Timer timer;
-static bool isInited = false; // 是否初始化完成
+#include <algorithm>
 
+static jfieldID contextField(JNIEnv* env, jobject thiz) {
+    static jfieldID field = env->GetFieldID(env->GetObjectClass(thiz), "nativeContext", "J");
+    return field;
+}
 
+static NativePlayer* getPlayer(JNIEnv* env, jobject thiz) {
+    return reinterpret_cast<NativePlayer*>(env->GetLongField(thiz, contextField(env, thiz)));
+}
 
+// 第一次用到时创建，release 时销毁
+static NativePlayer* getOrCreatePlayer(JNIEnv* env, jobject thiz) {
+    NativePlayer* player = getPlayer(env, thiz);
+    if (!player) {
+        player = new NativePlayer();
+        env->SetLongField(thiz, contextField(env, thiz), reinterpret_cast<jlong>(player));
+    }
+    return player;
+}
 
-// 线程句柄
-static std::thread demuxerThread;
-static std::thread decoderThread;
-static std::thread rendererThread;
-static std::thread audioDecoderThread;
-static std::thread aAudioPlayerThread;
 
-extern void demuxThread(const char* path, PacketQueue* videoQueue, PacketQueue* audioQueue, int videoStreamIndex, int audioStreamIndex);
-extern void decodeThread(PacketQueue* packetQueue, FrameQueue* frameQueue, AVCodecParameters* codecpar);
-extern void renderThread(FrameQueue* frameQueue, ANativeWindow* window, AVRational time_base);
-extern void audioDecodeThread(PacketQueue* packetQueue, AudioRingBuffer* ringBuffer, AVCodecParameters* codecpar);
-extern void AAudioPlayerThread(AudioRingBuffer* ringBuffer);
+static JavaVM* javaVm = nullptr;
+
+// 在 native 线程（prepare、渲染、音频输出）上回调 Java 时临时附加到 JVM
+template <typename F>
+static void withEnv(F&& fn) {
+    JNIEnv* env = nullptr;
+    bool attached = false;
+    if (javaVm->GetEnv((void**) &env, JNI_VERSION_1_6) == JNI_EDETACHED) {
+        javaVm->AttachCurrentThread(&env, nullptr);
+        attached = true;
+    }
+    fn(env);
+    if (attached) javaVm->DetachCurrentThread();
+}
+
+// prepare 结果转给 Player.onNativePrepared；Player 的全局引用随回调一起释放
+static std::function<void(int)> preparedCallback(JNIEnv* env, jobject thiz) {
+    env->GetJavaVM(&javaVm);
+    static jmethodID method = env->GetMethodID(env->GetObjectClass(thiz), "onNativePrepared", "(I)V");
+    std::shared_ptr<_jobject> ref(env->NewGlobalRef(thiz), [](jobject obj) {
+        withEnv([obj](JNIEnv* env) { env->DeleteGlobalRef(obj); });
+    });
+    return [ref](int result) {
+        withEnv([&](JNIEnv* env) { env->CallVoidMethod(ref.get(), method, result); });
+    };
+}
 
 
 extern "C"
 JNIEXPORT jint JNICALL
-Java_com_example_androidplayer_Player_nativePlay(JNIEnv *env, jobject thiz, jstring file,
-                                                 jobject surface) {
-    if (isInited){
-        timer.resume();
-        return 0;
+Java_com_example_androidplayer_Player_nativePrepare(JNIEnv *env, jobject thiz, jstring file,
+                                                    jobject surface) {
+    ANativeWindow* window = ANativeWindow_fromSurface(env, surface);
+    if (!window) {
+        LOGE("❌ ANativeWindow_fromSurface failed! surface is null.");
+        return -1;
     }
-    Timer::isPlaying = true; // 设置为正在播放
 
     // 处理文件路径
     const char* src = env->GetStringUTFChars(file, nullptr);
-    videoPath = src;
+    std::string path = src;
     env->ReleaseStringUTFChars(file, src);
-    LOGI("📁 nativeSetDataSource: %s", videoPath.c_str());
 
-    // 设置 surface
-    if (nativeWindow) {
-        ANativeWindow_release(nativeWindow);
-        nativeWindow = nullptr;
-    }
-    nativeWindow = ANativeWindow_fromSurface(env, surface);
-    if (!nativeWindow) {
-        LOGE("❌ ANativeWindow_fromSurface failed! surface is null.");
-        return -1;
-    }
+    return getOrCreatePlayer(env, thiz)->prepare(path.c_str(), window, preparedCallback(env, thiz));
+}
 
-    LOGI("✅ nativeSetSurface success: window=%p", nativeWindow);
 
-    LOGI("▶️ nativeStart");
+extern "C"
+JNIEXPORT jint JNICALL
+Java_com_example_androidplayer_Player_nativeStart(JNIEnv *env, jobject thiz) {
+    NativePlayer* player = getPlayer(env, thiz);
+    return player ? player->start() : -1;
+}
 
-    // 初始化全局状态
-    avformat_network_init();
 
-    packetQueue = new PacketQueue();        // video
-    audioPacketQueue = new PacketQueue();   // ✅ audio
-    frameQueue = new FrameQueue();
+extern "C"
+JNIEXPORT void JNICALL
+Java_com_example_androidplayer_Player_nativeRelease(JNIEnv *env, jobject thiz) {
+    NativePlayer* player = getPlayer(env, thiz);
+    if (!player) return;
+    delete player;
+    env->SetLongField(thiz, contextField(env, thiz), 0);
+}
 
-    // 打开视频获取 AVFormatContext
-    if (avformat_open_input(&formatCtx, videoPath.c_str(), nullptr, nullptr) != 0) {
-        LOGE("❌ Failed to open input file.");
-        return -1;
-    }
 
-    if (avformat_find_stream_info(formatCtx, nullptr) < 0) {
-        LOGE("❌ Failed to find stream info.");
-        return -2;
-    }
+extern "C"
+JNIEXPORT void JNICALL
+Java_com_example_androidplayer_Player_nativeSetCacheDir(JNIEnv *env, jclass clazz, jstring dir) {
+    const char* src = env->GetStringUTFChars(dir, nullptr);
+    setProgramCacheDir(src);
+    env->ReleaseStringUTFChars(dir, src);
+}
 
-    // 找到视频流和音频流索引
-    for (unsigned int i = 0; i < formatCtx->nb_streams; i++) {
-        if (formatCtx->streams[i]->codecpar->codec_type == AVMEDIA_TYPE_VIDEO) {
-            videoStreamIndex = i;
-            videoTimeBase = formatCtx->streams[i]->time_base;
-            LOGI("🎥 Video stream index: %d", videoStreamIndex);
-        }
-        if (formatCtx->streams[i]->codecpar->codec_type == AVMEDIA_TYPE_AUDIO){
-            audioStreamIndex = i;
-            LOGI("🎵 Audio stream index: %d", audioStreamIndex);
-        }
-    }
 
-    if (videoStreamIndex == -1) {
-        LOGE("❌ No video stream found.");
-        return -3;
-    }
+extern "C"
+JNIEXPORT void JNICALL
+Java_com_example_androidplayer_Player_nativeSetStandbyCache(JNIEnv *env, jclass clazz, jint entries, jint megabytes) {
+    StandbyCache::instance().configure(std::max(0, entries), (size_t) std::max(0, megabytes) << 20);
+}
 
-    if (audioStreamIndex == -1) {
-        LOGE("❌ No audio stream found.");
-        return -4;
-    }
 
-    LOGI("📦 Starting demux/decode/render threads...");
+extern "C"
+JNIEXPORT void JNICALL
+Java_com_example_androidplayer_Player_nativeTrimStandby(JNIEnv *env, jclass clazz, jint keep) {
+    StandbyCache::instance().trim(std::max(0, keep));
+}
 
-    demuxerThread = std::thread(demuxThread, videoPath.c_str(), packetQueue, audioPacketQueue, videoStreamIndex, audioStreamIndex);
-    decoderThread = std::thread(decodeThread, packetQueue, frameQueue,
-                                formatCtx->streams[videoStreamIndex]->codecpar);
-    rendererThread = std::thread(renderThread, frameQueue, nativeWindow, videoTimeBase);
-    audioDecoderThread = std::thread(audioDecodeThread, audioPacketQueue, audioRingBuffer,
-                                formatCtx->streams[audioStreamIndex]->codecpar);
-    aAudioPlayerThread = std::thread(AAudioPlayerThread, audioRingBuffer);
 
-    timer.setCurrentTime(0); // 设置初始时间为 0
-    timer.setTimeSpeed(1.0); // 设置时间倍率为 1.0
-    timer.start(); // 启动计时器线程
-    LOGI("⏱️ Timer started with initial time: %.3f", Timer::getCurrentTime());
+extern "C"
+JNIEXPORT void JNICALL
+Java_com_example_androidplayer_Player_nativeSetSurface(JNIEnv *env, jobject thiz, jobject surface) {
+    NativePlayer* player = getPlayer(env, thiz);
+    if (!player) return;
+    // null 表示分离
+    ANativeWindow* window = surface ? ANativeWindow_fromSurface(env, surface) : nullptr;
+    player->setSurface(window);
+}
 
 
-    // 可选：detach 或 join 管理线程生命周期
-    demuxerThread.detach();
-    decoderThread.detach();
-    rendererThread.detach();
-    audioDecoderThread.detach();
-    aAudioPlayerThread.detach();
+extern "C"
+JNIEXPORT jint JNICALL
+Java_com_example_androidplayer_Player_nativeSetAudioOnly(JNIEnv *env, jobject thiz, jboolean audioOnly) {
+    NativePlayer* player = getPlayer(env, thiz);
+    return player ? player->setAudioOnly(audioOnly) : -1;
+}
 
-    isInited = true;
 
-    return 0;
+extern "C"
+JNIEXPORT void JNICALL
+Java_com_example_androidplayer_Player_nativeSetRefreshRate(JNIEnv *env, jobject thiz, jfloat hz) {
+    getOrCreatePlayer(env, thiz)->setRefreshRate(hz);
 }
 
 
-
 extern "C"
 JNIEXPORT void JNICALL
 Java_com_example_androidplayer_Player_nativePause(JNIEnv *env, jobject thiz, jboolean p) {
-    timer.pause();
+    NativePlayer* player = getPlayer(env, thiz);
+    if (player) player->pause(p);
 }
 
 
 extern "C"
 JNIEXPORT jint JNICALL
 Java_com_example_androidplayer_Player_nativeSeek(JNIEnv *env, jobject thiz, jdouble position) {
-    timer.seekTo(position);
-    return 0;
+    NativePlayer* player = getPlayer(env, thiz);
+    return player ? player->seek(position) : -1;
 }
 
 
 extern "C"
-JNIEXPORT jint JNICALL
-Java_com_example_androidplayer_Player_nativeStop(JNIEnv *env, jobject thiz) {
-    LOGI("🛑 nativeStop called");
-//    isPlaying = false;
-
-    // 停止主时钟
-    timer.pause();
-    timer.setCurrentTime(0);
-    Timer::isPlaying = false;
-
-    // 释放 native window
-    if (nativeWindow) {
-        ANativeWindow_release(nativeWindow);
-        nativeWindow = nullptr;
-        LOGI("🧹 Released ANativeWindow");
-    }
+JNIEXPORT void JNICALL
+Java_com_example_androidplayer_Player_nativeHintSeek(JNIEnv *env, jobject thiz, jdouble position) {
+    NativePlayer* player = getPlayer(env, thiz);
+    if (player) player->hintSeek(position);
+}
 
-    // 关闭并释放 AVFormatContext
-    if (formatCtx) {
-        avformat_close_input(&formatCtx);  // 自动释放 streams
-        formatCtx = nullptr;
-        LOGI("🧹 Closed AVFormatContext");
-    }
 
-    // 释放 PacketQueue（video）
-    if (packetQueue) {
-        delete packetQueue;
-        packetQueue = nullptr;
-        LOGI("🧹 Deleted video PacketQueue");
-    }
+extern "C"
+JNIEXPORT void JNICALL
+Java_com_example_androidplayer_Player_nativeBeginScrub(JNIEnv *env, jobject thiz) {
+    NativePlayer* player = getPlayer(env, thiz);
+    if (player) player->beginScrub();
+}
 
-    // 释放 PacketQueue（audio）
-    if (audioPacketQueue) {
-        delete audioPacketQueue;
-        audioPacketQueue = nullptr;
-        LOGI("🧹 Deleted audio PacketQueue");
-    }
 
-    // 释放 FrameQueue
-    if (frameQueue) {
-        delete frameQueue;
-        frameQueue = nullptr;
-        LOGI("🧹 Deleted FrameQueue");
-    }
+extern "C"
+JNIEXPORT jint JNICALL
+Java_com_example_androidplayer_Player_nativeEndScrub(JNIEnv *env, jobject thiz, jdouble position) {
+    NativePlayer* player = getPlayer(env, thiz);
+    return player ? player->endScrub(position) : -1;
+}
 
-    // 重建 AudioRingBuffer（或你也可以添加 clear 函数）
-    if (audioRingBuffer) {
-        delete audioRingBuffer;
-        audioRingBuffer = new AudioRingBuffer(9600000);  // 预分配一样大小
-        LOGI("🔄 Reset AudioRingBuffer");
-    }
 
-    // 清空视频路径和流索引
-    videoPath.clear();
-    videoStreamIndex = -1;
-    audioStreamIndex = -1;
+extern "C"
+JNIEXPORT jint JNICALL
+Java_com_example_androidplayer_Player_nativeStepForward(JNIEnv *env, jobject thiz) {
+    NativePlayer* player = getPlayer(env, thiz);
+    return player ? player->stepForward() : -1;
+}
+
 
-    isInited = false;
+extern "C"
+JNIEXPORT jint JNICALL
+Java_com_example_androidplayer_Player_nativeStepBackward(JNIEnv *env, jobject thiz) {
+    NativePlayer* player = getPlayer(env, thiz);
+    return player ? player->stepBackward() : -1;
+}
 
-    LOGI("✅ All playback resources cleaned up");
-    return 0;
+
+extern "C"
+JNIEXPORT jint JNICALL
+Java_com_example_androidplayer_Player_nativeStop(JNIEnv *env, jobject thiz) {
+    NativePlayer* player = getPlayer(env, thiz);
+    return player ? player->stop() : 0;
 }
 
 
 extern "C"
 JNIEXPORT jint JNICALL
 Java_com_example_androidplayer_Player_nativeSetSpeed(JNIEnv *env, jobject thiz, jfloat speed) {
-    timer.setTimeSpeed(speed);
-    return 0;
+    return getOrCreatePlayer(env, thiz)->setSpeed(speed);
 }
 
 
 extern "C"
 JNIEXPORT jdouble JNICALL
 Java_com_example_androidplayer_Player_nativeGetPosition(JNIEnv *env, jobject thiz) {
-    return timer.getCurrentTime();
+    NativePlayer* player = getPlayer(env, thiz);
+    return player ? player->getPosition() : 0;
 }
 
 
+extern "C"
+JNIEXPORT jint JNICALL
+Java_com_example_androidplayer_Player_nativeSetLoop(JNIEnv *env, jobject thiz, jdouble start, jdouble end) {
+    NativePlayer* player = getPlayer(env, thiz);
+    return player ? player->setLoop(start, end) : -1;
+}
+
 
 extern "C"
 JNIEXPORT jdouble JNICALL
 Java_com_example_androidplayer_Player_nativeGetDuration(JNIEnv *env, jobject thiz) {
-    if (formatCtx == nullptr) {
-        LOGE("❌ Format context is null, cannot get duration");
-        return -1; // 错误处理：返回 -1 表示无法获取时长
-    }
+    NativePlayer* player = getPlayer(env, thiz);
+    return player ? player->getDuration() : -1;
+}
 
-    // 获取视频时长（单位：微秒），并转换为秒
-    double durationInSeconds = formatCtx->duration / AV_TIME_BASE;
-    LOGI("⏳ Video duration: %.3f seconds", durationInSeconds);
 
-    return durationInSeconds;
-}
\ No newline at end of file
+extern "C"
+JNIEXPORT jstring JNICALL
+Java_com_example_androidplayer_Player_nativeGetStats(JNIEnv *env, jobject thiz) {
+    NativePlayer* player = getPlayer(env, thiz);
+    return env->NewStringUTF(player ? player->getStats().c_str() : "");
+}
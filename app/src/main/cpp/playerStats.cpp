@@ -0,0 +1,216 @@
+//
+// playerStats.cpp
+//
+
+#include "playerStats.h"
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+}
+
+#include <chrono>
+#include <algorithm>
+#include <cstdio>
+#include <pthread.h>
+
+static int64_t nowUs() {
+    using namespace std::chrono;
+    return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+int64_t PlayerStats::threadCpuUs(clockid_t clock) {
+    struct timespec ts{};
+    if (clock_gettime(clock, &ts) != 0) return 0;
+    return (int64_t) ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+PlayerStats::ThreadScope::ThreadScope(PlayerStats* stats) : stats(stats), clock(CLOCK_THREAD_CPUTIME_ID) {
+    pthread_getcpuclockid(pthread_self(), &clock);
+    std::lock_guard<std::mutex> lock(stats->threadMtx);
+    stats->threadClocks.push_back(clock);
+}
+
+PlayerStats::ThreadScope::~ThreadScope() {
+    std::lock_guard<std::mutex> lock(stats->threadMtx);
+    auto& clocks = stats->threadClocks;
+    clocks.erase(std::find(clocks.begin(), clocks.end(), clock));
+    stats->exitedThreadCpuUs += threadCpuUs(clock);
+}
+
+int64_t PlayerStats::pipelineCpuUs() const {
+    std::lock_guard<std::mutex> lock(threadMtx);
+    int64_t total = exitedThreadCpuUs + taskCpuUs.load() + sliceCpuUs.load();
+    for (clockid_t clock : threadClocks) total += threadCpuUs(clock);
+    return total;
+}
+
+void PlayerStats::reset() {
+    decodeThreadType = 0;
+    decodeThreadCount = 0;
+    decodedFrames = 0;
+    decodeTimeUs = 0;
+    decodeCpuUs = 0;
+    convertKernel = "none";
+    convertSlices = 0;
+    convertedFrames = 0;
+    convertTimeUs = 0;
+    swsCacheHits = 0;
+    swsCacheMisses = 0;
+    startTimeUs = nowUs();
+    sourcePixels = 0;
+    convertedPixels = 0;
+    uploadedPixels = 0;
+    framePoolHits = 0;
+    framePoolMisses = 0;
+    frameCacheHits = 0;
+    frameCacheMisses = 0;
+    reverseFrames = 0;
+    reverseDecodedFrames = 0;
+    loopWraps = 0;
+    loopReplayedPasses = 0;
+    scrubRequests = 0;
+    scrubPreviews = 0;
+    speculativeHits = 0;
+    speculativeMisses = 0;
+    speculativeDecodeUs = 0;
+    speculativeWastedUs = 0;
+    trickKeyframes = 0;
+    presentedFrames = 0;
+    decimatedFrames = 0;
+    lateFrames = 0;
+    elidedFrames = 0;
+    elidedConvertUs = 0;
+    elidedBytes = 0;
+    staticHashUs = 0;
+    demuxWakeups = 0;
+    audioDecodeWakeups = 0;
+    videoDecodeWakeups = 0;
+    renderWakeups = 0;
+    audioOutputWakeups = 0;
+    prepareUs = -1;
+    rendererInitUs = 0;
+    programUs = 0;
+    programCached = false;
+    startRequestUs = 0;
+    firstFrameUs = -1;
+    surfaceDetaches = 0;
+    reattachUs = -1;
+    audioOnly = false;
+    standbyState = 0;
+    standbyFrames = 0;
+    taskCpuUs = 0;
+    sliceCpuUs = 0;
+    {
+        // 上一次播放的线程都已退出
+        std::lock_guard<std::mutex> lock(threadMtx);
+        exitedThreadCpuUs = 0;
+    }
+    modeStartUs = startTimeUs.load();
+    modeStartCpuUs = pipelineCpuUs();
+    videoModeUs = 0;
+    videoModeCpuUs = 0;
+    audioOnlyUs = 0;
+    audioOnlyCpuUs = 0;
+}
+
+void PlayerStats::markAudioOnly(bool enabled) {
+    if (audioOnly.load() == enabled) return;
+    int64_t now = nowUs();
+    int64_t cpu = pipelineCpuUs();
+    (audioOnly.load() ? audioOnlyUs : videoModeUs) += now - modeStartUs.load();
+    (audioOnly.load() ? audioOnlyCpuUs : videoModeCpuUs) += cpu - modeStartCpuUs.load();
+    modeStartUs = now;
+    modeStartCpuUs = cpu;
+    audioOnly = enabled;
+}
+
+void PlayerStats::markPrepared() {
+    prepareUs = nowUs() - startTimeUs.load();
+}
+
+void PlayerStats::markStart() {
+    startRequestUs = nowUs();
+    firstFrameUs = -1;
+}
+
+void PlayerStats::markFirstFrame() {
+    int64_t start = startRequestUs.load();
+    int64_t unset = -1;
+    if (start > 0) firstFrameUs.compare_exchange_strong(unset, nowUs() - start);
+}
+
+std::string PlayerStats::toString() const {
+    char buf[2816];
+    int type = decodeThreadType.load();
+    int threads = decodeThreadCount.load();
+    int64_t frames = decodedFrames.load();
+    double msPerFrame = frames > 0 ? decodeTimeUs.load() / 1000.0 / frames : 0.0;
+    double cpuMsPerFrame = frames > 0 ? decodeCpuUs.load() / 1000.0 / frames : 0.0;
+    int64_t converted = convertedFrames.load();
+    double convertMs = converted > 0 ? convertTimeUs.load() / 1000.0 / converted : 0.0;
+    double seconds = (nowUs() - startTimeUs.load()) / 1e6;
+    if (seconds <= 0) seconds = 1;
+
+    // 当前这一段还没结算，算进所在的模式；CPU 占用按一个核的百分比
+    int64_t openUs = nowUs() - modeStartUs.load();
+    int64_t openCpuUs = pipelineCpuUs() - modeStartCpuUs.load();
+    bool inAudioOnly = audioOnly.load();
+    int64_t videoUs = videoModeUs.load() + (inAudioOnly ? 0 : openUs);
+    int64_t videoCpu = videoModeCpuUs.load() + (inAudioOnly ? 0 : openCpuUs);
+    int64_t audioUs = audioOnlyUs.load() + (inAudioOnly ? openUs : 0);
+    int64_t audioCpu = audioOnlyCpuUs.load() + (inAudioOnly ? openCpuUs : 0);
+    double videoLoad = videoUs > 0 ? videoCpu * 100.0 / videoUs : 0.0;
+    double audioLoad = audioUs > 0 ? audioCpu * 100.0 / audioUs : 0.0;
+    double saved = videoUs > 0 && audioUs > 0 ? videoLoad - audioLoad : 0.0;
+
+    snprintf(buf, sizeof(buf),
+             "decode threads: %s x%d (cpu big=%d little=%d)\n"
+             "decode: %lld frames, %.2f ms/frame, %.2f ms/frame cpu on the decoding thread\n"
+             "convert: %s x%d slices, %lld frames, %.2f ms/frame\n"
+             "convert cache: %lld hits, %lld misses\n"
+             "pixels/s: source %.1fM, converted %.1fM, uploaded %.1fM\n"
+             "frame pool: %lld hits, %lld misses\n"
+             "frame cache: %lld hits, %lld misses\n"
+             "reverse: %lld shown, %lld decoded\n"
+             "loop: %lld wraps, %lld replayed from cache\n"
+             "scrub: %lld requests, %lld previews\n"
+             "speculative: %lld hits, %lld misses, %.1f ms decoded, %.1f ms wasted\n"
+             "trick play: %lld keyframes\n"
+             "fps: decoded %.1f, converted %.1f, presented %.1f (%lld decimated, %lld late)\n"
+             "static frames: %lld elided, %.1f ms convert and %.1f MB upload saved, %.1f ms hashing\n"
+             "wakeups/s: demux %.1f, audio decode %.1f, video decode %.1f, render %.1f, audio out %.1f\n"
+             "startup: prepare %.1f ms, renderer %.1f ms (%.0f%%, program %s %.1f ms), first frame %.1f ms after start\n"
+             "surface: %lld detaches, reattach to frame %.1f ms\n"
+             "cpu (this player): video %.1f%% over %.1f s, audio only %.1f%% over %.1f s, saved %.1f%% of a core\n"
+             "standby: %s, %lld first-GOP frames shown\n",
+             type == FF_THREAD_FRAME ? "frame" : type == FF_THREAD_SLICE ? "slice" : "none",
+             threads, cpuBigCores.load(), cpuLittleCores.load(),
+             (long long) frames, msPerFrame, cpuMsPerFrame,
+             convertKernel.load(), convertSlices.load(), (long long) converted, convertMs,
+             (long long) swsCacheHits.load(), (long long) swsCacheMisses.load(),
+             sourcePixels.load() / seconds / 1e6, convertedPixels.load() / seconds / 1e6,
+             uploadedPixels.load() / seconds / 1e6,
+             (long long) framePoolHits.load(), (long long) framePoolMisses.load(),
+             (long long) frameCacheHits.load(), (long long) frameCacheMisses.load(),
+             (long long) reverseFrames.load(), (long long) reverseDecodedFrames.load(),
+             (long long) loopWraps.load(), (long long) loopReplayedPasses.load(),
+             (long long) scrubRequests.load(), (long long) scrubPreviews.load(),
+             (long long) speculativeHits.load(), (long long) speculativeMisses.load(),
+             speculativeDecodeUs.load() / 1000.0, speculativeWastedUs.load() / 1000.0,
+             (long long) trickKeyframes.load(),
+             frames / seconds, converted / seconds, presentedFrames.load() / seconds,
+             (long long) decimatedFrames.load(), (long long) lateFrames.load(),
+             (long long) elidedFrames.load(), elidedConvertUs.load() / 1000.0, elidedBytes.load() / 1048576.0,
+             staticHashUs.load() / 1000.0,
+             demuxWakeups.load() / seconds, audioDecodeWakeups.load() / seconds, videoDecodeWakeups.load() / seconds,
+             renderWakeups.load() / seconds, audioOutputWakeups.load() / seconds,
+             prepareUs.load() / 1000.0, rendererInitUs.load() / 1000.0,
+             prepareUs.load() > 0 ? rendererInitUs.load() * 100.0 / prepareUs.load() : 0.0,
+             programCached.load() ? "cached" : "compiled", programUs.load() / 1000.0,
+             firstFrameUs.load() / 1000.0,
+             (long long) surfaceDetaches.load(), reattachUs.load() / 1000.0,
+             videoLoad, videoUs / 1e6, audioLoad, audioUs / 1e6, saved,
+             standbyState.load() == 2 ? "hit" : standbyState.load() == 1 ? "miss" : "off",
+             (long long) standbyFrames.load());
+    return buf;
+}
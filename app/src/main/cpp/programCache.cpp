@@ -0,0 +1,169 @@
+//
+// programCache.cpp
+//
+
+#include "programCache.h"
+#include "log.h"
+#define TAG "programCache"
+
+#include <EGL/egl.h>
+#include <GLES2/gl2ext.h>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+static std::mutex cacheDirMutex;
+static std::string cacheDir;
+// 多个播放器同时启动时读写同一个缓存文件（临时文件名相同）；EGL 上下文各自独立，不需要加锁
+static std::mutex cacheFileMutex;
+
+void setProgramCacheDir(const std::string& dir) {
+    std::lock_guard<std::mutex> lock(cacheDirMutex);
+    cacheDir = dir;
+}
+
+static std::string getCacheDir() {
+    std::lock_guard<std::mutex> lock(cacheDirMutex);
+    return cacheDir;
+}
+
+static GLuint compileShader(GLenum type, const char* src) {
+    GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &src, nullptr);
+    glCompileShader(shader);
+    return shader;
+}
+
+static GLuint createProgram(const char* vertexSrc, const char* fragmentSrc) {
+    GLuint vs = compileShader(GL_VERTEX_SHADER, vertexSrc);
+    GLuint fs = compileShader(GL_FRAGMENT_SHADER, fragmentSrc);
+    GLuint program = glCreateProgram();
+    glAttachShader(program, vs);
+    glAttachShader(program, fs);
+    glLinkProgram(program);
+    // 链接后着色器对象不再需要，随程序一起释放
+    glDeleteShader(vs);
+    glDeleteShader(fs);
+    return program;
+}
+
+static const char* glString(GLenum name) {
+    const GLubyte* s = glGetString(name);
+    return s ? (const char*) s : "";
+}
+
+// 缓存键：驱动和着色器源码，驱动升级或着色器修改后旧的二进制自动作废
+static std::string cacheKey(const char* vertexSrc, const char* fragmentSrc) {
+    std::string key = glString(GL_RENDERER);
+    key += '\n';
+    key += glString(GL_VERSION);
+    key += '\n';
+    key += vertexSrc;
+    key += '\n';
+    key += fragmentSrc;
+    return key;
+}
+
+// FNV-1a，只用来生成文件名；文件里保存完整的键，读出时再比较
+static uint64_t hashKey(const std::string& key) {
+    uint64_t h = 1469598103934665603ULL;
+    for (unsigned char c : key) {
+        h ^= c;
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+// 文件格式：键长度、键、二进制格式、程序二进制
+static bool readCache(const std::string& path, const std::string& key, GLenum& format, std::vector<char>& binary) {
+    FILE* file = fopen(path.c_str(), "rb");
+    if (!file) return false;
+    bool ok = false;
+    uint32_t keySize = 0;
+    if (fread(&keySize, sizeof(keySize), 1, file) == 1 && keySize == key.size()) {
+        std::string stored(keySize, '\0');
+        if (fread(&stored[0], 1, keySize, file) == keySize && stored == key &&
+            fread(&format, sizeof(format), 1, file) == 1) {
+            char chunk[4096];
+            size_t n;
+            while ((n = fread(chunk, 1, sizeof(chunk), file)) > 0) binary.insert(binary.end(), chunk, chunk + n);
+            ok = !binary.empty();
+        }
+    }
+    fclose(file);
+    return ok;
+}
+
+static void writeCache(const std::string& path, const std::string& key, GLenum format, const std::vector<char>& binary) {
+    // 先写临时文件再改名，多个播放器同时写或中途退出都不会留下半个文件
+    std::string tmp = path + ".tmp";
+    FILE* file = fopen(tmp.c_str(), "wb");
+    if (!file) return;
+    uint32_t keySize = key.size();
+    bool ok = fwrite(&keySize, sizeof(keySize), 1, file) == 1 &&
+              fwrite(key.data(), 1, key.size(), file) == key.size() &&
+              fwrite(&format, sizeof(format), 1, file) == 1 &&
+              fwrite(binary.data(), 1, binary.size(), file) == binary.size();
+    ok = fclose(file) == 0 && ok;
+    if (ok && rename(tmp.c_str(), path.c_str()) == 0) {
+        LOGI("💾 Saved program binary: %zu bytes", binary.size());
+    } else {
+        remove(tmp.c_str());
+    }
+}
+
+GLuint loadProgram(const char* vertexSrc, const char* fragmentSrc, bool* cached) {
+    *cached = false;
+    std::string dir = getCacheDir();
+    GLint formats = 0;
+    if (!dir.empty() && strstr(glString(GL_EXTENSIONS), "GL_OES_get_program_binary")) {
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS_OES, &formats);
+    }
+    auto getProgramBinary = (PFNGLGETPROGRAMBINARYOESPROC) eglGetProcAddress("glGetProgramBinaryOES");
+    auto programBinary = (PFNGLPROGRAMBINARYOESPROC) eglGetProcAddress("glProgramBinaryOES");
+    if (formats <= 0 || !getProgramBinary || !programBinary) {
+        return createProgram(vertexSrc, fragmentSrc);
+    }
+
+    std::string key = cacheKey(vertexSrc, fragmentSrc);
+    char name[64];
+    snprintf(name, sizeof(name), "/gl_program_%016llx.bin", (unsigned long long) hashKey(key));
+    std::string path = dir + name;
+
+    GLenum format = 0;
+    std::vector<char> binary;
+    bool hit;
+    {
+        std::lock_guard<std::mutex> lock(cacheFileMutex);
+        hit = readCache(path, key, format, binary);
+    }
+    if (hit) {
+        GLuint program = glCreateProgram();
+        programBinary(program, format, binary.data(), (GLint) binary.size());
+        GLint linked = GL_FALSE;
+        glGetProgramiv(program, GL_LINK_STATUS, &linked);
+        if (linked) {
+            *cached = true;
+            return program;
+        }
+        // 驱动拒绝了这份二进制（版本号没变但格式变了），重新编译覆盖它
+        LOGI("⚠️ Cached program binary rejected, recompiling");
+        glDeleteProgram(program);
+    }
+
+    GLuint program = createProgram(vertexSrc, fragmentSrc);
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH_OES, &length);
+    if (length > 0) {
+        binary.assign(length, 0);
+        GLsizei written = 0;
+        getProgramBinary(program, length, &written, &format, binary.data());
+        if (written > 0) {
+            binary.resize(written);
+            std::lock_guard<std::mutex> lock(cacheFileMutex);
+            writeCache(path, key, format, binary);
+        }
+    }
+    return program;
+}
@@ -5,23 +5,30 @@
 
 #include "frameQueue.h"
 #include "timer.h"
+#include "playerStats.h"
+#include "surfaceSize.h"
+#include "playbackControl.h"
+#include "programCache.h"
+#include "surfaceSlot.h"
 
-#include <mutex>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
 
 extern "C" {
 #include <libavutil/frame.h>
 #include <android/native_window_jni.h>
 }
 
-std::mutex renderInitMutex;
-
 static const char* vertexShaderCode = R"(
 attribute vec4 aPosition;
 attribute vec2 aTexCoord;
+uniform vec2 uTexScale;
 varying vec2 vTexCoord;
 void main() {
     gl_Position = aPosition;
-    vTexCoord = aTexCoord;
+    vTexCoord = aTexCoord * uTexScale;
 }
 )";
 
@@ -34,25 +41,8 @@ void main() {
 }
 )";
 
-GLuint compileShader(GLenum type, const char* src) {
-    GLuint shader = glCreateShader(type);
-    glShaderSource(shader, 1, &src, nullptr);
-    glCompileShader(shader);
-    return shader;
-}
-
-GLuint createProgram(const char* vertexSrc, const char* fragmentSrc) {
-    GLuint vs = compileShader(GL_VERTEX_SHADER, vertexSrc);
-    GLuint fs = compileShader(GL_FRAGMENT_SHADER, fragmentSrc);
-    GLuint program = glCreateProgram();
-    glAttachShader(program, vs);
-    glAttachShader(program, fs);
-    glLinkProgram(program);
-    return program;
-}
-
-void initRenderContext(RenderContext* ctx, ANativeWindow* window, int width, int height) {
-    std::lock_guard<std::mutex> lock(renderInitMutex);
+void initRenderContext(RenderContext* ctx, ANativeWindow* window, int width, int height, PlayerStats* stats) {
+    auto initStart = std::chrono::steady_clock::now();
 
     if (ctx->initialized && ctx->window == window) {
         LOGI("🛡️ Already initialized with same surface, skipping");
@@ -83,6 +73,7 @@ void initRenderContext(RenderContext* ctx, ANativeWindow* window, int width, int
             EGL_NONE
     };
     eglChooseConfig(ctx->display, attribs, &config, 1, &numConfigs);
+    ctx->config = config;
 
     EGLint format;
     eglGetConfigAttrib(ctx->display, config, EGL_NATIVE_VISUAL_ID, &format);
@@ -94,10 +85,21 @@ void initRenderContext(RenderContext* ctx, ANativeWindow* window, int width, int
     ctx->context = eglCreateContext(ctx->display, config, EGL_NO_CONTEXT, ctxAttribs);
     eglMakeCurrent(ctx->display, ctx->surface, ctx->surface, ctx->context);
 
-    ctx->program = createProgram(vertexShaderCode, fragmentShaderCode);
+    // 视口按 Surface 实际尺寸，而不是帧尺寸
+    eglQuerySurface(ctx->display, ctx->surface, EGL_WIDTH, &ctx->width);
+    eglQuerySurface(ctx->display, ctx->surface, EGL_HEIGHT, &ctx->height);
+
+    // 程序二进制缓存命中时跳过着色器编译
+    auto programStart = std::chrono::steady_clock::now();
+    bool cached = false;
+    ctx->program = loadProgram(vertexShaderCode, fragmentShaderCode, &cached);
+    stats->programUs = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - programStart).count();
+    stats->programCached = cached;
     ctx->positionLoc = glGetAttribLocation(ctx->program, "aPosition");
     ctx->texCoordLoc = glGetAttribLocation(ctx->program, "aTexCoord");
     ctx->samplerLoc = glGetUniformLocation(ctx->program, "uTexture");
+    ctx->texScaleLoc = glGetUniformLocation(ctx->program, "uTexScale");
 
     GLfloat vertices[] = {
             -1.0f, -1.0f,  // bottom left
@@ -127,17 +129,91 @@ void initRenderContext(RenderContext* ctx, ANativeWindow* window, int width, int
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
     ctx->initialized = true;
+    stats->rendererInitUs = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - initStart).count();
+    LOGI("✅ Renderer ready in %.1f ms (program %s in %.1f ms)", stats->rendererInitUs.load() / 1000.0,
+         cached ? "loaded from cache" : "compiled", stats->programUs.load() / 1000.0);
+}
+
+// 每个渲染线程一个 EGL 上下文，线程结束时释放
+void releaseRenderContext(RenderContext* ctx) {
+    if (!ctx->initialized) return;
+    glDeleteTextures(1, &ctx->texture);
+    glDeleteBuffers(1, &ctx->vertexBuffer);
+    glDeleteBuffers(1, &ctx->texCoordBuffer);
+    glDeleteProgram(ctx->program);
+    eglMakeCurrent(ctx->display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    if (ctx->surface != EGL_NO_SURFACE) eglDestroySurface(ctx->display, ctx->surface);
+    eglDestroyContext(ctx->display, ctx->context);
+    *ctx = RenderContext();
 }
 
-void renderFrameToSurface(AVFrame* frame, ANativeWindow* window) {
-    static RenderContext ctx;
+// 只换输出窗口：销毁旧的 EGLSurface，上下文、程序和纹理都保留；window 为空时上下文不绑定任何 Surface
+static void switchRenderSurface(RenderContext& ctx, ANativeWindow* window) {
+    eglMakeCurrent(ctx.display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    if (ctx.surface != EGL_NO_SURFACE) eglDestroySurface(ctx.display, ctx.surface);
+    ctx.surface = EGL_NO_SURFACE;
+    ctx.window = window;
+    if (!window) {
+        LOGI("🔌 Surface detached, EGL context kept");
+        return;
+    }
+
+    EGLint format;
+    eglGetConfigAttrib(ctx.display, ctx.config, EGL_NATIVE_VISUAL_ID, &format);
+    ANativeWindow_setBuffersGeometry(window, 0, 0, format);
+    ctx.surface = eglCreateWindowSurface(ctx.display, ctx.config, window, nullptr);
+    eglMakeCurrent(ctx.display, ctx.surface, ctx.surface, ctx.context);
+    eglQuerySurface(ctx.display, ctx.surface, EGL_WIDTH, &ctx.width);
+    eglQuerySurface(ctx.display, ctx.surface, EGL_HEIGHT, &ctx.height);
+    LOGI("🔌 Surface attached: %dx%d", ctx.width, ctx.height);
+}
+
+// 上传帧到纹理，不绘制；预滚动时第一帧先上传好，start 后只剩绘制和交换
+static void uploadFrame(RenderContext& ctx, AVFrame* frame, ANativeWindow* window, SurfaceSize* surfaceSize,
+                        PlayerStats* stats) {
     if (!ctx.initialized || ctx.window != window) {
         LOGI("⚠️ EGL context not initialized or surface changed, reinitializing...");
-        initRenderContext(&ctx, window, frame->width, frame->height);
+        initRenderContext(&ctx, window, frame->width, frame->height, stats);
     }
 
+    // Surface 尺寸变化时通知解码线程重新协商转换尺寸
+    EGLint surfaceWidth = 0, surfaceHeight = 0;
+    eglQuerySurface(ctx.display, ctx.surface, EGL_WIDTH, &surfaceWidth);
+    eglQuerySurface(ctx.display, ctx.surface, EGL_HEIGHT, &surfaceHeight);
+    if (surfaceWidth != ctx.width || surfaceHeight != ctx.height) {
+        LOGI("📐 Surface resized: %dx%d -> %dx%d", ctx.width, ctx.height, surfaceWidth, surfaceHeight);
+        ctx.width = surfaceWidth;
+        ctx.height = surfaceHeight;
+    }
+    surfaceSize->set(ctx.width, ctx.height);
+
     LOGD("🖼️ Frame size: %dx%d  linesize=%d", frame->width, frame->height, frame->linesize[0]);
 
+    glUseProgram(ctx.program);
+
+    // 上传纹理：GLES2 没有 GL_UNPACK_ROW_LENGTH，按 linesize 整行上传，再用 uTexScale 裁掉对齐填充
+    bool rgb565 = frame->format == AV_PIX_FMT_RGB565;
+    int bytesPerPixel = rgb565 ? 2 : 4;
+    int texWidth = frame->linesize[0] / bytesPerPixel;
+    GLenum glFormat = rgb565 ? GL_RGB : GL_RGBA;
+    GLenum glType = rgb565 ? GL_UNSIGNED_SHORT_5_6_5 : GL_UNSIGNED_BYTE;
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, ctx.texture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, bytesPerPixel);
+    glTexImage2D(GL_TEXTURE_2D, 0, glFormat, texWidth, frame->height,
+                 0, glFormat, glType, frame->data[0]);
+    glUniform2f(ctx.texScaleLoc, (GLfloat) frame->width / texWidth, 1.0f);
+    stats->uploadedPixels += (int64_t) texWidth * frame->height;
+    GLenum err = glGetError();
+    if (err != GL_NO_ERROR) {
+        LOGE("❌ glTexImage2D error: 0x%x", err);
+    }
+}
+
+// 用当前纹理绘制并交换到屏幕
+static void presentFrame(RenderContext& ctx) {
     glViewport(0, 0, ctx.width, ctx.height);
     glUseProgram(ctx.program);
 
@@ -151,16 +227,6 @@ void renderFrameToSurface(AVFrame* frame, ANativeWindow* window) {
     glEnableVertexAttribArray(ctx.texCoordLoc);
     glVertexAttribPointer(ctx.texCoordLoc, 2, GL_FLOAT, GL_FALSE, 0, nullptr);
 
-    // 上传纹理
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, ctx.texture);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, frame->width, frame->height,
-                 0, GL_RGBA, GL_UNSIGNED_BYTE, frame->data[0]);
-    GLenum err = glGetError();
-    if (err != GL_NO_ERROR) {
-        LOGE("❌ glTexImage2D error: 0x%x", err);
-    }
-
     glUniform1i(ctx.samplerLoc, 0);
 
     // 清屏并绘制
@@ -179,36 +245,158 @@ void renderFrameToSurface(AVFrame* frame, ANativeWindow* window) {
     }
 }
 
-void renderThread(FrameQueue* frameQueue, ANativeWindow* window, AVRational time_base) {
-    if (!Timer::isPlaying){
+void renderFrameToSurface(RenderContext& ctx, AVFrame* frame, ANativeWindow* window, SurfaceSize* surfaceSize,
+                          PlayerStats* stats) {
+    uploadFrame(ctx, frame, window, surfaceSize, stats);
+    presentFrame(ctx);
+}
+
+// 帧距离显示时间还有多少秒（实际时间）：倒放时主时钟递减按方向换算，倍速时按倍率折算
+static double dueDelay(double frameTime, PlaybackControl* control, Timer* timer) {
+    return (frameTime - timer->getCurrentTime()) * control->getDirection() / std::fabs(control->getSpeed());
+}
+
+// 等到帧的显示时间：播放中一次睡到点，暂停时阻塞到恢复或步进移动主时钟；倍速变化也会提前醒来重新计算。
+// 跳转或停止时立即返回 false。每次醒来先调用 onWake（处理 Surface 变化）
+static bool waitUntilDue(double frameTime, int serial, PlaybackControl* control, Timer* timer, PlayerStats* stats,
+                         const std::function<void()>& onWake) {
+    while (true) {
+        double delay = dueDelay(frameTime, control, timer);
+        bool paused = control->isPaused();
+        if (delay <= 0.002 || (!paused && delay >= 1.0)) return true;
+        bool waiting = paused ? control->waitWhilePaused(serial) : control->sleepFor(delay, serial);
+        stats->renderWakeups++;
+        onWake();
+        if (!waiting) return false;
+    }
+}
+
+// 渲染线程在探测文件之前启动，EGL 和着色器准备与打开、探测并行；timeBase 在探测后才写入，第一帧出队之后才读。
+// 输出窗口从 surfaceSlot 取，播放中可以分离和更换
+void renderThread(FrameQueue* frameQueue, SurfaceSlot* surfaceSlot, const AVRational* timeBase,
+                  SurfaceSize* surfaceSize, PlaybackControl* control, Timer* timer, PlayerStats* stats) {
+    if (control->isStopped()){
         return;
     }
-    while (!(frameQueue->isFinished() && frameQueue->empty())) {
+    PlayerStats::ThreadScope cpuScope(stats);
+    ANativeWindow* window = surfaceSlot->open();
+    RenderContext ctx;
+    AVFrame* shownFrame = nullptr;  // 屏幕上的帧（分离期间是最近解出的关键帧），换 Surface 后立即重画
+
+    // 分离时只放下 EGLSurface；新 Surface 到来时在原上下文上创建 EGLSurface，并立即画出当前帧
+    auto serviceSurface = [&]() {
+        ANativeWindow* next;
+        SurfaceSlot::Clock::time_point requested;
+        // 先取走标记再查看：之后的 set 会重新置位，下一次等待立即返回
+        control->takeSurfaceSignal();
+        if (!surfaceSlot->poll(next, requested)) return;
+        if (ctx.initialized) switchRenderSurface(ctx, next);
+        window = next;
+        surfaceSlot->acknowledge();
+        if (!window || !shownFrame) return;
+        renderFrameToSurface(ctx, shownFrame, window, surfaceSize, stats);
+        stats->reattachUs = std::chrono::duration_cast<std::chrono::microseconds>(
+                SurfaceSlot::Clock::now() - requested).count();
+        LOGI("🖼️ Frame shown %.1f ms after reattach", stats->reattachUs.load() / 1000.0);
+    };
+
+    // 显示过的帧留着，之前的释放；不带数据的帧内容没变，保留原来的
+    auto keepShown = [&](AVFrame*& frame) {
+        if (!frame->data[0]) return;
+        av_frame_free(&shownFrame);
+        shownFrame = frame;
+        frame = nullptr;
+    };
+
+    int renderSerial = control->getSerial();
+    // 预滚动：等第一帧时就建好 EGL 上下文
+    bool preroll = control->isPrerolling();
+    if (preroll && window) {
+        initRenderContext(&ctx, window, ANativeWindow_getWidth(window), ANativeWindow_getHeight(window), stats);
+    }
+    while (!control->isStopped()) {
+        serviceSurface();
         AVFrame* frame = frameQueue->pop();
-        if (!frame) continue;
+        stats->renderWakeups++;
+        if (!frame) {
+            if (frameQueue->isFinished()) break;  // 停止
+            continue;  // 被 Surface 变化唤醒
+        }
+
+        // 跳转前转换出来的帧
+        int serial = serialOf(frame->opaque);
+        if (serial != control->getSerial()) {
+            av_frame_free(&frame);
+            continue;
+        }
 
-        double time_sec = frame->pts * av_q2d(time_base);
-        double master_time = Timer::getCurrentTime(); // 主时钟 ⏱️
-        double delay = time_sec - master_time;
+        if (preroll) {
+            // 第一帧上传后报告就绪，start 后只需绘制和交换，下一个 vsync 就能显示；
+            // start 前跳转则丢掉它，按跳转后的第一帧立即显示
+            preroll = false;
+            bool uploaded = window != nullptr;
+            if (uploaded) uploadFrame(ctx, frame, window, surfaceSize, stats);
+            control->prerollDone();
+            bool resumed = true;
+            while (resumed && control->isPaused()) {
+                resumed = control->waitWhilePaused(serial);
+                serviceSurface();
+            }
+            if (resumed) {
+                if (window) {
+                    // 等待期间换过 Surface 也没关系，纹理在上下文里
+                    if (uploaded) presentFrame(ctx);
+                    else renderFrameToSurface(ctx, frame, window, surfaceSize, stats);
+                    stats->presentedFrames++;
+                    stats->markFirstFrame();
+                }
+                control->setDisplayedPts(frame->pts);
+                keepShown(frame);
+            }
+            av_frame_free(&frame);
+            continue;
+        }
+
+        double time_sec = frame->pts * av_q2d(*timeBase);
+        double master_time = timer->getCurrentTime(); // 主时钟 ⏱️
+        double delay = dueDelay(time_sec, control, timer);
 
 
         // 打印调试时间戳
         LOGD("🖼️ Rendering Time=%.3f, Clock=%.3f, Delay=%.3f",
              time_sec, master_time, delay);
 
-        if (delay > 0.02 && delay < 1.0) {
+        if (serial != renderSerial) {
+            // 跳转后的第一帧覆盖目标时间，无论早晚都立即显示
+            renderSerial = serial;
+        } else if (delay > 0.02) {
             // 如果时间还没到，睡一小会儿等它到点再播放
-            std::this_thread::sleep_for(std::chrono::milliseconds((int)(delay * 1000)));
+            if (!waitUntilDue(time_sec, serial, control, timer, stats, serviceSurface)) {
+                av_frame_free(&frame);
+                continue;
+            }
         } else if (delay < -0.1) {
             // 太迟了，说明滞后了，丢掉这个帧（如果你愿意）
             LOGI("⚠️ Frame too late, skipping it...");
+            stats->lateFrames++;
             av_frame_free(&frame);
             continue;
         }
 
         // ✅ 调用此函数进行渲染
-        renderFrameToSurface(frame, window);
+        // 不带数据的帧：内容和屏幕上的一样，不用上传和重绘；分离期间只记下它，不渲染
+        if (frame->data[0] && window) {
+            renderFrameToSurface(ctx, frame, window, surfaceSize, stats);
+            stats->presentedFrames++;
+            stats->markFirstFrame();
+        }
+        control->setDisplayedPts(frame->pts);
+        keepShown(frame);
 
         av_frame_free(&frame);
     }
-}
\ No newline at end of file
+    av_frame_free(&shownFrame);
+    // 先释放 EGLSurface，再让等待中的 set 返回，之后窗口才会被释放
+    releaseRenderContext(&ctx);
+    surfaceSlot->close();
+}
@@ -0,0 +1,246 @@
+//
+// reverseDecoder.cpp
+//
+
+#include "reverseDecoder.h"
+#include "log.h"
+#define TAG "reverseDecoder"
+#include "threadPolicy.h"
+
+#include <algorithm>
+
+// 一段最多缓存的解码数据量；GOP 更长时分段：每次从关键帧重新解码，只保留该段末尾的帧
+static const size_t segmentBytes = 32 << 20;
+static const size_t minSegmentFrames = 4;
+// 已解码、等待显示的批次数，再加上正在解码和正在显示的各一批，内存约为 3 * segmentBytes
+static const size_t maxReadyBatches = 1;
+
+static size_t frameBytes(const AVFrame* frame) {
+    size_t total = 0;
+    for (AVBufferRef* buf : frame->buf) {
+        if (buf) total += buf->size;
+    }
+    return total;
+}
+
+static void freeFrames(std::deque<AVFrame*>& frames) {
+    for (AVFrame* frame : frames) av_frame_free(&frame);
+    frames.clear();
+}
+
+ReverseDecoder::ReverseDecoder(const char* path, int lowres, PlaybackControl* control, Timer* timer,
+                               PlayerStats* stats, int serial)
+        : lowres(lowres), control(control), timer(timer), stats(stats), serial(serial) {
+    // 跳转和停止时唤醒批次之间的等待；停止还会打断文件读取
+    controlListener = control->addListener([this]() {
+        std::lock_guard<std::mutex> lock(mtx);
+        cv.notify_all();
+    });
+    formatCtx = avformat_alloc_context();
+    formatCtx->interrupt_callback = control->cancelToken()->interruptCallback();
+    if (avformat_open_input(&formatCtx, path, nullptr, nullptr) != 0) {
+        LOGE("❌ Failed to open input: %s", path);
+        return;
+    }
+    if (avformat_find_stream_info(formatCtx, nullptr) < 0) {
+        LOGE("❌ Failed to find stream info");
+        return;
+    }
+
+    const AVCodec* codec = nullptr;
+    streamIndex = av_find_best_stream(formatCtx, AVMEDIA_TYPE_VIDEO, -1, -1, &codec, 0);
+    if (streamIndex < 0 || !codec) {
+        LOGE("❌ No video stream for reverse playback");
+        streamIndex = -1;
+        return;
+    }
+
+    // 只解码视频流，其余的包在读取时直接丢掉
+    for (unsigned int i = 0; i < formatCtx->nb_streams; i++) {
+        if ((int) i != streamIndex) formatCtx->streams[i]->discard = AVDISCARD_ALL;
+    }
+
+    AVCodecParameters* codecpar = formatCtx->streams[streamIndex]->codecpar;
+    codecCtx = avcodec_alloc_context3(codec);
+    if (!codecCtx || avcodec_parameters_to_context(codecCtx, codecpar) < 0) {
+        LOGE("❌ Failed to create codec context");
+        avcodec_free_context(&codecCtx);
+        return;
+    }
+    codecCtx->pkt_timebase = formatCtx->streams[streamIndex]->time_base;
+    codecCtx->lowres = lowres;
+    applyDecodeThreading(codecCtx, chooseDecodeThreading(codec, codecpar, false));
+    if (avcodec_open2(codecCtx, codec, nullptr) < 0) {
+        LOGE("❌ Failed to open codec");
+        avcodec_free_context(&codecCtx);
+    }
+}
+
+ReverseDecoder::~ReverseDecoder() {
+    control->removeListener(controlListener);
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        stopping = true;
+        cv.notify_all();
+    }
+    if (worker.joinable()) worker.join();
+
+    for (auto& batch : batches) {
+        for (AVFrame* frame : batch) av_frame_free(&frame);
+    }
+    avcodec_free_context(&codecCtx);
+    avformat_close_input(&formatCtx);
+}
+
+bool ReverseDecoder::start(int64_t startPts) {
+    if (!codecCtx) return false;
+    worker = std::thread(&ReverseDecoder::run, this, startPts);
+    return true;
+}
+
+bool ReverseDecoder::cancelled() const {
+    return stopping || control->isStopped() || control->getSerial() != serial;
+}
+
+bool ReverseDecoder::nextBatch(std::vector<AVFrame*>& frames) {
+    std::unique_lock<std::mutex> lock(mtx);
+    cv.wait(lock, [this] { return !batches.empty() || done || cancelled(); });
+    if (batches.empty() || cancelled()) return false;
+
+    frames = std::move(batches.front());
+    batches.pop_front();
+    cv.notify_all();
+    return true;
+}
+
+bool ReverseDecoder::pushBatch(std::deque<AVFrame*>& frames) {
+    std::unique_lock<std::mutex> lock(mtx);
+    cv.wait(lock, [this] { return batches.size() < maxReadyBatches || cancelled(); });
+    if (cancelled()) {
+        freeFrames(frames);
+        return false;
+    }
+    batches.emplace_back(frames.begin(), frames.end());
+    frames.clear();
+    cv.notify_all();
+    return true;
+}
+
+// 读出 endPts 之前最近的关键帧开始、到下一个关键帧为止的所有包
+bool ReverseDecoder::readGop(int64_t endPts, std::vector<AVPacket*>& packets, int64_t& keyPts) {
+    if (avformat_seek_file(formatCtx, streamIndex, INT64_MIN, endPts - 1, endPts - 1, 0) < 0) {
+        return false;
+    }
+
+    keyPts = AV_NOPTS_VALUE;
+    AVPacket* pkt = av_packet_alloc();
+    while (!cancelled() && av_read_frame(formatCtx, pkt) >= 0) {
+        if (pkt->stream_index != streamIndex) {
+            av_packet_unref(pkt);
+            continue;
+        }
+        bool key = pkt->flags & AV_PKT_FLAG_KEY;
+        if (keyPts == AV_NOPTS_VALUE) {
+            // 定位不准时跳过关键帧之前的包
+            if (!key || pkt->pts == AV_NOPTS_VALUE) {
+                av_packet_unref(pkt);
+                continue;
+            }
+            keyPts = pkt->pts;
+        } else if (key) {
+            break;
+        }
+        packets.push_back(av_packet_clone(pkt));
+        av_packet_unref(pkt);
+    }
+    av_packet_free(&pkt);
+
+    // 已经到第一个 GOP：定位落在 endPts 或之后
+    return keyPts != AV_NOPTS_VALUE && keyPts < endPts;
+}
+
+// 从关键帧解码整段包，保留 [keyPts, endPts) 内最后 segmentFrames 帧，返回该区间内的总帧数
+int ReverseDecoder::decodeSegment(const std::vector<AVPacket*>& packets, int64_t keyPts, int64_t endPts,
+                                  std::deque<AVFrame*>& frames) {
+    avcodec_flush_buffers(codecCtx);
+
+    int total = 0;
+    bool reachedEnd = false;
+    AVFrame* frame = av_frame_alloc();
+
+    auto receive = [&]() {
+        while (avcodec_receive_frame(codecCtx, frame) == 0) {
+            stats->reverseDecodedFrames++;
+            int64_t pts = frame->best_effort_timestamp;
+            if (pts == AV_NOPTS_VALUE || pts < keyPts) {
+                av_frame_unref(frame);
+                continue;
+            }
+            if (pts >= endPts) {
+                // 按显示顺序输出，后面的帧都在区间之外
+                reachedEnd = true;
+                av_frame_unref(frame);
+                continue;
+            }
+            if (segmentFrames == 0) {
+                size_t bytes = std::max<size_t>(1, frameBytes(frame));
+                segmentFrames = std::max(minSegmentFrames, segmentBytes / bytes);
+                LOGI("⏪ Reverse segment: %zu frames of %zu bytes", segmentFrames, bytes);
+            }
+            AVFrame* kept = av_frame_alloc();
+            av_frame_move_ref(kept, frame);
+            frames.push_back(kept);
+            total++;
+            if (frames.size() > segmentFrames) {
+                av_frame_free(&frames.front());
+                frames.pop_front();
+            }
+        }
+    };
+
+    for (AVPacket* pkt : packets) {
+        if (reachedEnd || cancelled()) break;
+        if (avcodec_send_packet(codecCtx, pkt) < 0) continue;
+        receive();
+    }
+    if (!reachedEnd && !cancelled()) {
+        avcodec_send_packet(codecCtx, nullptr);
+        receive();
+    }
+
+    av_frame_free(&frame);
+    return total;
+}
+
+void ReverseDecoder::run(int64_t startPts) {
+    PlayerStats::ThreadScope cpuScope(stats);
+    LOGI("⏪ Reverse decoder started at pts=%lld", (long long) startPts);
+
+    int64_t end = startPts + 1;  // 不含
+    while (!cancelled()) {
+        std::vector<AVPacket*> packets;
+        int64_t keyPts;
+        bool ok = readGop(end, packets, keyPts);
+
+        // GOP 太长时分多段，从最后一段开始，每段都从关键帧重新解码
+        int64_t segmentEnd = end;
+        while (ok && !cancelled()) {
+            std::deque<AVFrame*> frames;
+            int total = decodeSegment(packets, keyPts, segmentEnd, frames);
+            if (frames.empty()) break;
+            segmentEnd = frames.front()->best_effort_timestamp;
+            bool whole = (size_t) total <= frames.size();
+            if (!pushBatch(frames)) break;
+            if (whole) break;
+        }
+
+        for (AVPacket* pkt : packets) av_packet_free(&pkt);
+        if (!ok) break;
+        end = keyPts;
+    }
+
+    std::lock_guard<std::mutex> lock(mtx);
+    done = true;
+    cv.notify_all();
+    LOGI("⏪ Reverse decoder finished");
+}
@@ -0,0 +1,108 @@
+//
+// sliceConverter.cpp
+//
+
+#include "sliceConverter.h"
+#include "log.h"
+#define TAG "sliceConverter"
+#include "playerStats.h"
+
+#include <algorithm>
+
+SliceConverter::SliceConverter(int maxSlices)
+        : maxSlices(std::max(1, std::min(maxSlices, TaskScheduler::instance().size()))) {}
+
+SliceConverter::~SliceConverter() {
+    wait();
+}
+
+bool SliceConverter::configure(const ConvertKey& key) {
+    plan = cache.acquire(key, maxSlices);
+    return plan != nullptr;
+}
+
+void SliceConverter::start(const AVFrame* src, AVFrame* dst) {
+    int slices = getSliceCount();
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        curSrc = src;
+        curDst = dst;
+        pendingSlices = slices;
+        startTime = std::chrono::steady_clock::now();
+    }
+
+    while ((int) tasks.size() < slices) {
+        tasks.push_back(std::make_shared<SliceTask>(this, (int) tasks.size()));
+    }
+    // 上一帧的条带任务可能刚报告完成、还没从 step 返回，这时的 wake 会在 step 结束后再执行一次，不会丢
+    for (int i = 0; i < slices; i++) tasks[i]->wake();
+}
+
+Task::Status SliceConverter::SliceTask::step() {
+    {
+        PlayerStats::CpuSpan cpuSpan(owner->cpuUs);
+        owner->convertSlice(index);
+    }
+    owner->sliceDone();
+    return Status::Blocked;
+}
+
+// 报告之后不再访问 SliceConverter，wait 返回后它可以被销毁
+void SliceConverter::sliceDone() {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (--pendingSlices == 0) {
+        lastConvertUs = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - startTime).count();
+        cv.notify_all();
+    }
+}
+
+int64_t SliceConverter::wait() {
+    std::unique_lock<std::mutex> lock(mtx);
+    cv.wait(lock, [this] { return pendingSlices == 0; });
+    return lastConvertUs;
+}
+
+int64_t SliceConverter::getCpuUs() const {
+    return cpuUs.load();
+}
+
+void SliceConverter::convertSlice(int index) {
+    int y0 = plan->sliceRows[index];
+    int y1 = plan->sliceRows[index + 1];
+
+    if (plan->scaler) {
+        if (sws_scale_frame(plan->scaler, curDst, curSrc) < 0) {
+            LOGE("❌ sws_scale_frame failed");
+        }
+        return;
+    }
+
+    if (plan->useYuvConverter) {
+        plan->yuvConverter.convert(curSrc, curDst, y0, y1);
+        return;
+    }
+
+    // 每个条带的 SwsContext 只有条带高度，把平面指针偏移到条带起始行
+    const uint8_t* srcData[4] = {};
+    for (int p = 0; p < 4; p++) {
+        if (!curSrc->data[p]) continue;
+        int rows = (!plan->rgbPlanes && (p == 1 || p == 2)) ? (y0 >> plan->chromaShift) : y0;
+        srcData[p] = curSrc->data[p] + (ptrdiff_t) rows * curSrc->linesize[p];
+    }
+    uint8_t* dstData[4] = {curDst->data[0] + (ptrdiff_t) y0 * curDst->linesize[0]};
+
+    sws_scale(plan->swsSlices[index], srcData, curSrc->linesize, 0, y1 - y0, dstData, curDst->linesize);
+}
+
+const char* SliceConverter::getKernelName() const {
+    return plan ? plan->getKernelName() : "none";
+}
+
+int SliceConverter::getSliceCount() const {
+    return plan ? plan->getSliceCount() : 0;
+}
+
+const SwsCache& SliceConverter::getCache() const {
+    return cache;
+}
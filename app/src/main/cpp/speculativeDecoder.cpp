@@ -0,0 +1,287 @@
+//
+// speculativeDecoder.cpp
+//
+
+#include "speculativeDecoder.h"
+#include "log.h"
+#define TAG "speculativeDecoder"
+#include "threadPolicy.h"
+
+#include <algorithm>
+#include <cmath>
+
+// 每个提示保留覆盖目标的一帧加之后的几帧，足够主解码器从关键帧追上来；不超过 frameQueue 深度
+static const size_t framesPerHint = 4;
+static const size_t maxHints = 3;
+// 单个提示最多读的包数，防止超长 GOP 拖住后台线程
+static const int maxPackets = 600;
+
+SpeculativeDecoder::SpeculativeDecoder(PlayerStats* stats) : stats(stats) {}
+
+SpeculativeDecoder::~SpeculativeDecoder() {
+    close();
+}
+
+void SpeculativeDecoder::open(const char* inputPath, int decodeLowres) {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (accepting) return;
+    path = inputPath;
+    lowres = decodeLowres;
+    accepting = true;
+    running = true;
+}
+
+void SpeculativeDecoder::close() {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        accepting = false;
+        running = false;
+        cv.notify_all();
+    }
+    if (worker.joinable()) worker.join();
+
+    std::lock_guard<std::mutex> lock(mtx);
+    for (Entry& entry : entries) {
+        stats->speculativeWastedUs += entry.decodeUs;
+        freeEntry(entry);
+    }
+    entries.clear();
+}
+
+void SpeculativeDecoder::freeEntry(Entry& entry) {
+    for (AVFrame* frame : entry.frames) av_frame_free(&frame);
+    entry.frames.clear();
+}
+
+void SpeculativeDecoder::hint(double target, double ttl) {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (!accepting) return;
+    auto expiry = Clock::now() + std::chrono::milliseconds((int64_t) (ttl * 1000));
+
+    // 同一位置的重复提示只延长有效期
+    for (auto it = entries.begin(); it != entries.end(); ++it) {
+        if (std::fabs(it->target - target) < 0.001) {
+            it->expiry = std::max(it->expiry, expiry);
+            entries.splice(entries.begin(), entries, it);
+            return;
+        }
+    }
+
+    entries.push_front(Entry{nextId++, target, expiry, false, {}, 0});
+    while (entries.size() > maxHints) {
+        stats->speculativeWastedUs += entries.back().decodeUs;
+        freeEntry(entries.back());
+        entries.pop_back();
+    }
+
+    // 第一个提示才打开文件和第二个解码器；上一个后台线程已经决定退出，它不再持锁，可以直接回收
+    if (!workerActive) {
+        if (worker.joinable()) worker.join();
+        workerActive = true;
+        worker = std::thread(&SpeculativeDecoder::run, this);
+    }
+    cv.notify_all();
+}
+
+bool SpeculativeDecoder::take(int64_t targetPts, std::vector<AVFrame*>& frames) {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (!accepting) return false;
+
+    for (auto it = entries.begin(); it != entries.end(); ++it) {
+        std::vector<AVFrame*>& decoded = it->frames;
+        if (decoded.empty()) continue;
+        // 最后一帧之后是否还有帧未知，所以目标必须落在第一帧和最后一帧之间
+        if (decoded.front()->best_effort_timestamp > targetPts ||
+            decoded.back()->best_effort_timestamp <= targetPts) {
+            continue;
+        }
+        size_t covering = 0;
+        while (covering + 1 < decoded.size() && decoded[covering + 1]->best_effort_timestamp <= targetPts) {
+            covering++;
+        }
+        for (size_t i = covering; i < decoded.size(); i++) {
+            frames.push_back(av_frame_clone(decoded[i]));
+        }
+        freeEntry(*it);
+        entries.erase(it);
+        stats->speculativeHits++;
+        return true;
+    }
+    stats->speculativeMisses++;
+    return false;
+}
+
+// close 时打断阻塞在网络读取上的后台线程
+int SpeculativeDecoder::isClosing(void* opaque) {
+    return static_cast<SpeculativeDecoder*>(opaque)->running ? 0 : 1;
+}
+
+bool SpeculativeDecoder::openInput() {
+    formatCtx = avformat_alloc_context();
+    formatCtx->interrupt_callback = {isClosing, this};
+    if (avformat_open_input(&formatCtx, path.c_str(), nullptr, nullptr) != 0) {
+        LOGE("❌ Failed to open input: %s", path.c_str());
+        return false;
+    }
+    if (avformat_find_stream_info(formatCtx, nullptr) < 0) {
+        LOGE("❌ Failed to find stream info");
+        return false;
+    }
+
+    const AVCodec* codec = nullptr;
+    streamIndex = av_find_best_stream(formatCtx, AVMEDIA_TYPE_VIDEO, -1, -1, &codec, 0);
+    if (streamIndex < 0 || !codec) {
+        LOGE("❌ No video stream for speculative decoding");
+        return false;
+    }
+    for (unsigned int i = 0; i < formatCtx->nb_streams; i++) {
+        if ((int) i != streamIndex) formatCtx->streams[i]->discard = AVDISCARD_ALL;
+    }
+
+    AVCodecParameters* codecpar = formatCtx->streams[streamIndex]->codecpar;
+    codecCtx = avcodec_alloc_context3(codec);
+    if (!codecCtx || avcodec_parameters_to_context(codecCtx, codecpar) < 0) {
+        LOGE("❌ Failed to create codec context");
+        return false;
+    }
+    codecCtx->pkt_timebase = formatCtx->streams[streamIndex]->time_base;
+    codecCtx->lowres = lowres;
+    // 只解码关键帧之后的少量帧，用 slice 线程避免帧线程的输出延迟
+    applyDecodeThreading(codecCtx, chooseDecodeThreading(codec, codecpar, true));
+    if (avcodec_open2(codecCtx, codec, nullptr) < 0) {
+        LOGE("❌ Failed to open codec");
+        return false;
+    }
+    return true;
+}
+
+void SpeculativeDecoder::closeInput() {
+    avcodec_free_context(&codecCtx);
+    avformat_close_input(&formatCtx);
+}
+
+// 从 target 之前的关键帧解码到覆盖 target 的帧之后 framesPerHint - 1 帧，返回耗时（微秒）
+int64_t SpeculativeDecoder::decodeAt(double target, std::vector<AVFrame*>& frames) {
+    auto startTime = Clock::now();
+    AVRational tb = formatCtx->streams[streamIndex]->time_base;
+    int64_t targetPts = llrint(target / av_q2d(tb));
+
+    if (avformat_seek_file(formatCtx, streamIndex, INT64_MIN, targetPts, targetPts, 0) < 0) {
+        LOGE("❌ Speculative seek to %.3f failed", target);
+        return 0;
+    }
+    avcodec_flush_buffers(codecCtx);
+
+    AVPacket* pkt = av_packet_alloc();
+    AVFrame* frame = av_frame_alloc();
+    AVFrame* held = nullptr;  // 目标之前的最后一帧
+    int packets = 0;
+    bool eof = false;
+
+    auto receive = [&]() {
+        while (frames.size() < framesPerHint && avcodec_receive_frame(codecCtx, frame) == 0) {
+            int64_t pts = frame->best_effort_timestamp;
+            if (pts != AV_NOPTS_VALUE && pts <= targetPts) {
+                av_frame_free(&held);
+                held = av_frame_clone(frame);
+            } else if (pts != AV_NOPTS_VALUE) {
+                if (frames.empty() && held) {
+                    frames.push_back(held);
+                    held = nullptr;
+                }
+                frames.push_back(av_frame_clone(frame));
+            }
+            av_frame_unref(frame);
+        }
+    };
+
+    while (frames.size() < framesPerHint && packets < maxPackets && !eof) {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            if (!running) break;
+        }
+        if (av_read_frame(formatCtx, pkt) < 0) {
+            avcodec_send_packet(codecCtx, nullptr);
+            eof = true;
+        } else {
+            packets++;
+            if (pkt->stream_index == streamIndex) avcodec_send_packet(codecCtx, pkt);
+            av_packet_unref(pkt);
+        }
+        receive();
+    }
+
+    av_frame_free(&held);
+    av_frame_free(&frame);
+    av_packet_free(&pkt);
+
+    int64_t us = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - startTime).count();
+    stats->speculativeDecodeUs += us;
+    LOGI("🔮 Pre-decoded %zu frames at %.3f in %.1f ms", frames.size(), target, us / 1000.0);
+    return us;
+}
+
+void SpeculativeDecoder::expire() {
+    auto now = Clock::now();
+    for (auto it = entries.begin(); it != entries.end();) {
+        if (it->expiry <= now) {
+            stats->speculativeWastedUs += it->decodeUs;
+            freeEntry(*it);
+            it = entries.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void SpeculativeDecoder::run() {
+    PlayerStats::ThreadScope cpuScope(stats);
+    bool opened = openInput();
+
+    std::unique_lock<std::mutex> lock(mtx);
+    if (!opened) {
+        // 打不开就不再接受提示，避免每个提示都重新打开一次
+        LOGE("❌ Speculative decoder disabled");
+        accepting = false;
+        for (Entry& entry : entries) freeEntry(entry);
+        entries.clear();
+    } else {
+        LOGI("🔮 Speculative decoder opened");
+    }
+    while (running && opened) {
+        expire();
+        // 提示都用完或过期：关闭输入和解码器，下一个提示再打开
+        if (entries.empty()) break;
+
+        auto pending = std::find_if(entries.begin(), entries.end(), [](const Entry& e) { return !e.decoded; });
+        if (pending == entries.end()) {
+            // 没有要解码的提示：等新的提示或关闭，最多等到最早过期的那个
+            auto earliest = std::min_element(entries.begin(), entries.end(),
+                                             [](const Entry& a, const Entry& b) { return a.expiry < b.expiry; });
+            cv.wait_until(lock, earliest->expiry);
+            continue;
+        }
+
+        // 解码时不持锁，期间提示可能被淘汰或被取走
+        int id = pending->id;
+        double target = pending->target;
+        pending->decoded = true;
+        lock.unlock();
+        std::vector<AVFrame*> frames;
+        int64_t us = decodeAt(target, frames);
+        lock.lock();
+
+        auto entry = std::find_if(entries.begin(), entries.end(), [&](const Entry& e) { return e.id == id; });
+        if (entry != entries.end()) {
+            entry->frames = std::move(frames);
+            entry->decodeUs = us;
+        } else {
+            stats->speculativeWastedUs += us;
+            for (AVFrame* f : frames) av_frame_free(&f);
+        }
+    }
+    // 和检查提示为空在同一段持锁区间里，之后的提示会启动新的线程
+    workerActive = false;
+    lock.unlock();
+    closeInput();
+}
@@ -0,0 +1,153 @@
+//
+// standbyCache.cpp
+//
+
+#include "standbyCache.h"
+#include "log.h"
+#define TAG "standbyCache"
+
+#include <algorithm>
+#include <sys/stat.h>
+
+// 每个条目缓存的第一个 GOP 最多这么多字节，长 GOP 只留开头的一部分
+static const size_t maxFirstGopBytes = 16 << 20;
+
+// 本地文件的大小和修改时间（纳秒），路径可以带 file: 前缀
+static bool statFile(const std::string& path, int64_t& size, int64_t& mtimeNs) {
+    std::string file = path.rfind("file:", 0) == 0 ? path.substr(5) : path;
+    struct stat st;
+    if (stat(file.c_str(), &st) != 0 || !S_ISREG(st.st_mode)) return false;
+    size = st.st_size;
+    mtimeNs = (int64_t) st.st_mtim.tv_sec * 1000000000 + st.st_mtim.tv_nsec;
+    return true;
+}
+
+static size_t frameBytes(const AVFrame* frame) {
+    size_t total = 0;
+    for (AVBufferRef* buf : frame->buf) {
+        if (buf) total += buf->size;
+    }
+    return total;
+}
+
+StandbyEntry::~StandbyEntry() {
+    for (AVFrame* frame : firstGop) av_frame_free(&frame);
+    avcodec_free_context(&videoCodecCtx);
+    avcodec_free_context(&audioCodecCtx);
+    avformat_close_input(&formatCtx);
+}
+
+int StandbyEntry::isInterrupted(void* opaque) {
+    const CancelToken* token = static_cast<StandbyEntry*>(opaque)->cancelToken.load();
+    return token && token->isCancelled() ? 1 : 0;
+}
+
+AVIOInterruptCB StandbyEntry::interruptCallback() {
+    return {isInterrupted, this};
+}
+
+void StandbyEntry::bind(const CancelToken* token) {
+    cancelToken = token;
+}
+
+bool StandbyEntry::stampFile() {
+    return statFile(path, fileSize, fileMtimeNs);
+}
+
+bool StandbyEntry::fileUnchanged() const {
+    int64_t size, mtimeNs;
+    return statFile(path, size, mtimeNs) && size == fileSize && mtimeNs == fileMtimeNs;
+}
+
+void StandbyEntry::captureFirstGop(const AVFrame* frame) {
+    if (firstGopDone) return;
+    if (frame->best_effort_timestamp == AV_NOPTS_VALUE) {
+        firstGopDone = true;  // 没有时间戳的帧重新播放时无法和解码出的帧对上
+        return;
+    }
+    if ((frame->flags & AV_FRAME_FLAG_KEY) && !firstGop.empty()) {
+        firstGopDone = true;
+        return;
+    }
+    size_t total = frameBytes(frame);
+    for (AVFrame* f : firstGop) total += frameBytes(f);
+    if (total > maxFirstGopBytes) {
+        firstGopDone = true;
+        return;
+    }
+    firstGop.push_back(av_frame_clone(frame));
+}
+
+size_t StandbyEntry::bytes() const {
+    size_t total = 0;
+    for (AVFrame* frame : firstGop) total += frameBytes(frame);
+    // 解码器内部按 YUV420 估算：每个线程一帧，加上重排序和参考帧
+    if (videoCodecCtx) {
+        size_t frame420 = (size_t) videoCodecCtx->width * videoCodecCtx->height * 3 / 2;
+        total += frame420 * (std::max(1, videoCodecCtx->thread_count) + videoCodecCtx->has_b_frames + 2);
+    }
+    return total;
+}
+
+StandbyCache& StandbyCache::instance() {
+    static StandbyCache cache;
+    return cache;
+}
+
+void StandbyCache::configure(size_t entryLimit, size_t byteLimit) {
+    std::lock_guard<std::mutex> lock(mtx);
+    maxEntries = entryLimit;
+    maxBytes = byteLimit;
+    evictLocked(maxEntries, maxBytes);
+    LOGI("🧊 Standby cache: %zu entries, %zu MB", maxEntries, maxBytes >> 20);
+}
+
+bool StandbyCache::enabled() {
+    std::lock_guard<std::mutex> lock(mtx);
+    return maxEntries > 0;
+}
+
+std::unique_ptr<StandbyEntry> StandbyCache::take(const std::string& path) {
+    std::lock_guard<std::mutex> lock(mtx);
+    for (auto it = entries.begin(); it != entries.end(); ++it) {
+        if ((*it)->path != path) continue;
+        std::unique_ptr<StandbyEntry> entry = std::move(*it);
+        entries.erase(it);
+        if (!entry->fileUnchanged()) {
+            // 同一路径上的文件被替换或改写过，旧的解复用器、解码器和帧都不能用
+            LOGI("🧊 Standby stale, evicted: %s", path.c_str());
+            return nullptr;
+        }
+        LOGI("🧊 Standby hit: %s", path.c_str());
+        return entry;
+    }
+    return nullptr;
+}
+
+void StandbyCache::put(std::unique_ptr<StandbyEntry> entry) {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (maxEntries == 0) return;  // 关闭时 entry 在这里释放
+    if (!entry->fileUnchanged()) {
+        LOGI("🧊 Standby skipped, file changed during playback: %s", entry->path.c_str());
+        return;
+    }
+    LOGI("🧊 Standby keep: %s, %zu frames, ~%zu KB", entry->path.c_str(), entry->firstGop.size(),
+         entry->bytes() >> 10);
+    entries.push_front(std::move(entry));
+    evictLocked(maxEntries, maxBytes);
+}
+
+void StandbyCache::trim(size_t keep) {
+    std::lock_guard<std::mutex> lock(mtx);
+    evictLocked(keep, maxBytes);
+}
+
+void StandbyCache::evictLocked(size_t keep, size_t budget) {
+    size_t total = 0;
+    for (auto& entry : entries) total += entry->bytes();
+    while (!entries.empty() && (entries.size() > keep || total > budget)) {
+        total -= entries.back()->bytes();
+        LOGI("🧊 Standby evict: %s", entries.back()->path.c_str());
+        entries.pop_back();
+    }
+}
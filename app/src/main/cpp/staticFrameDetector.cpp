@@ -0,0 +1,166 @@
+//
+// staticFrameDetector.cpp
+//
+
+#include "staticFrameDetector.h"
+#include "log.h"
+#define TAG "staticFrameDetector"
+
+extern "C" {
+#include "libavutil/pixdesc.h"
+#include "libavutil/imgutils.h"
+}
+
+#include <chrono>
+#include <cstring>
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define STATIC_X86 1
+#endif
+
+// 全跳过的 P 帧只有片头和一个 mb_skip_run，几个片加起来也在这个量级；有任何编码宏块都会更大。
+// 只对 H.264 成立：P_Skip 在全跳过的帧里运动矢量全为零，就是参考帧的拷贝；HEVC 的跳过块走 merge 候选
+// （包括时域运动矢量），不保证拷贝参考帧；VP9/AV1 的小包常常是 show_existing_frame，显示的是另一帧
+static const int maxSkipPacketBytes = 48;
+// 每隔几行取一行参与哈希；哈希只用来快速排除变化的帧，相同与否由逐字节比较决定
+static const int rowStep = 4;
+
+static const uint64_t fnvPrime = 0x100000001b3ULL;
+
+static inline uint64_t mix(uint64_t h, uint64_t v) {
+    return (h ^ v) * fnvPrime;
+}
+
+static uint64_t hashTail(const uint8_t* p, int start, int bytes, uint64_t h) {
+    for (int i = start; i < bytes; i++) h = mix(h, p[i]);
+    return h;
+}
+
+// 一行的哈希：位置相关的异或累加（逐字节旋转后异或）加上字节和
+static uint64_t hashRow(const uint8_t* p, int bytes, uint64_t h) {
+    int x = 0;
+#if defined(__ARM_NEON)
+    uint8x16_t acc = vdupq_n_u8(0);
+    uint16x8_t sum = vdupq_n_u16(0);
+    for (; x + 16 <= bytes; x += 16) {
+        uint8x16_t v = vld1q_u8(p + x);
+        acc = veorq_u8(vextq_u8(acc, acc, 1), v);
+        sum = vpadalq_u8(sum, v);
+    }
+    uint64x2_t a = vreinterpretq_u64_u8(acc);
+    uint64x2_t s = vpaddlq_u32(vpaddlq_u16(sum));
+    h = mix(h, vgetq_lane_u64(a, 0));
+    h = mix(h, vgetq_lane_u64(a, 1));
+    h = mix(h, vgetq_lane_u64(s, 0) + (vgetq_lane_u64(s, 1) << 32));
+#elif defined(STATIC_X86)
+    __m128i acc = _mm_setzero_si128();
+    __m128i sum = _mm_setzero_si128();
+    const __m128i zero = _mm_setzero_si128();
+    for (; x + 16 <= bytes; x += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*) (p + x));
+        acc = _mm_xor_si128(_mm_or_si128(_mm_srli_si128(acc, 1), _mm_slli_si128(acc, 15)), v);
+        sum = _mm_add_epi64(sum, _mm_sad_epu8(v, zero));
+    }
+    uint64_t lanes[4];
+    _mm_storeu_si128((__m128i*) lanes, acc);
+    _mm_storeu_si128((__m128i*) (lanes + 2), sum);
+    for (uint64_t lane : lanes) h = mix(h, lane);
+#else
+    for (; x + 8 <= bytes; x += 8) {
+        uint64_t w;
+        memcpy(&w, p + x, 8);
+        h = mix(h, w);
+    }
+#endif
+    return hashTail(p, x, bytes, h);
+}
+
+// 可能被检测的平面行字节数和行数
+static bool planeGeometry(const AVFrame* frame, const AVPixFmtDescriptor* desc, int plane, int& bytes, int& rows) {
+    bytes = av_image_get_linesize((AVPixelFormat) frame->format, frame->width, plane);
+    bool chroma = plane == 1 || plane == 2;
+    rows = chroma ? AV_CEIL_RSHIFT(frame->height, desc->log2_chroma_h) : frame->height;
+    return bytes > 0;
+}
+
+StaticFrameDetector::StaticFrameDetector() : reference(av_frame_alloc()) {}
+
+StaticFrameDetector::~StaticFrameDetector() {
+    av_frame_free(&reference);
+}
+
+void StaticFrameDetector::tagPacket(AVPacket* pkt, AVCodecID codecId) {
+    if (codecId != AV_CODEC_ID_H264) return;
+    if ((pkt->flags & AV_PKT_FLAG_KEY) || pkt->size <= 0 || pkt->size > maxSkipPacketBytes) return;
+    av_buffer_unref(&pkt->opaque_ref);
+    pkt->opaque_ref = av_buffer_alloc(1);
+}
+
+uint64_t StaticFrameDetector::hashFrame(const AVFrame* frame) {
+    const AVPixFmtDescriptor* desc = av_pix_fmt_desc_get((AVPixelFormat) frame->format);
+    uint64_t h = 0xcbf29ce484222325ULL;
+    if (!desc) return h;
+
+    int bytes, rows;
+    for (int plane = 0; plane < 4 && frame->data[plane]; plane++) {
+        if (!planeGeometry(frame, desc, plane, bytes, rows)) continue;
+        for (int y = 0; y < rows; y += rowStep) {
+            h = hashRow(frame->data[plane] + (ptrdiff_t) y * frame->linesize[plane], bytes, h);
+        }
+    }
+    return h;
+}
+
+// 抽样哈希相同后逐字节确认：没有参与哈希的行和哈希碰撞都不会让画面停住
+bool StaticFrameDetector::samePixels(const AVFrame* a, const AVFrame* b) {
+    if (a->format != b->format || a->width != b->width || a->height != b->height) return false;
+    const AVPixFmtDescriptor* desc = av_pix_fmt_desc_get((AVPixelFormat) a->format);
+    if (!desc) return false;
+
+    int bytes, rows;
+    for (int plane = 0; plane < 4 && a->data[plane]; plane++) {
+        if (!b->data[plane]) return false;
+        if (!planeGeometry(a, desc, plane, bytes, rows)) continue;
+        for (int y = 0; y < rows; y++) {
+            if (memcmp(a->data[plane] + (ptrdiff_t) y * a->linesize[plane],
+                       b->data[plane] + (ptrdiff_t) y * b->linesize[plane], bytes) != 0) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool StaticFrameDetector::isUnchanged(const AVFrame* frame, bool reordered) {
+    // 编码器只写了跳过宏块：和解码顺序上的上一帧相同。有 B 帧重排序时解码顺序上的上一帧不一定是上一次显示的帧
+    if (valid && !reordered && frame->opaque_ref) return true;
+
+    auto start = std::chrono::steady_clock::now();
+    uint64_t hash = hashFrame(frame);
+    bool unchanged = valid && hash == lastHash && samePixels(frame, reference);
+    hashUs += std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+    if (!unchanged) {
+        // 新的比较基准：持有一份引用供逐字节确认
+        lastHash = hash;
+        av_frame_unref(reference);
+        if (av_frame_ref(reference, frame) < 0) {
+            valid = false;
+            return false;
+        }
+    }
+    valid = true;
+    return unchanged;
+}
+
+void StaticFrameDetector::invalidate() {
+    valid = false;
+    av_frame_unref(reference);
+}
+
+int64_t StaticFrameDetector::getHashUs() const {
+    return hashUs;
+}
@@ -0,0 +1,52 @@
+//
+// surfaceSlot.cpp
+//
+
+#include "surfaceSlot.h"
+
+void SurfaceSlot::setWaker(std::function<void()> fn) {
+    std::lock_guard<std::mutex> lock(mtx);
+    waker = std::move(fn);
+}
+
+void SurfaceSlot::set(ANativeWindow* newWindow) {
+    std::unique_lock<std::mutex> lock(mtx);
+    window = newWindow;
+    requested = Clock::now();
+    if (!active) return;  // 渲染线程还没开始或已经退出，open 时直接取
+    changed = true;
+    // 唤醒在渲染线程的等待条件里置位，不会丢失，唤醒一次就够
+    std::function<void()> wake = waker;
+    lock.unlock();
+    if (wake) wake();
+    lock.lock();
+    cv.wait(lock, [this] { return !changed || !active; });
+}
+
+ANativeWindow* SurfaceSlot::open() {
+    std::lock_guard<std::mutex> lock(mtx);
+    active = true;
+    changed = false;
+    return window;
+}
+
+void SurfaceSlot::close() {
+    std::lock_guard<std::mutex> lock(mtx);
+    active = false;
+    changed = false;
+    cv.notify_all();
+}
+
+bool SurfaceSlot::poll(ANativeWindow*& out, Clock::time_point& outRequested) {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (!changed) return false;
+    out = window;
+    outRequested = requested;
+    return true;
+}
+
+void SurfaceSlot::acknowledge() {
+    std::lock_guard<std::mutex> lock(mtx);
+    changed = false;
+    cv.notify_all();
+}
@@ -0,0 +1,162 @@
+//
+// swsCache.cpp
+//
+
+#include "swsCache.h"
+#include "log.h"
+#define TAG "swsCache"
+
+extern "C" {
+#include <libavutil/pixdesc.h>
+#include <libavutil/macros.h>
+}
+
+#include <algorithm>
+
+ConvertKey ConvertKey::fromFrame(const AVFrame* src, int dstWidth, int dstHeight, AVPixelFormat dstFormat) {
+    ConvertKey key;
+    key.srcWidth = src->width;
+    key.srcHeight = src->height;
+    key.srcFormat = (AVPixelFormat) src->format;
+    key.colorspace = src->colorspace;
+    key.range = src->color_range;
+    key.dstWidth = dstWidth;
+    key.dstHeight = dstHeight;
+    key.dstFormat = dstFormat;
+    return key;
+}
+
+bool ConvertKey::operator==(const ConvertKey& other) const {
+    return srcWidth == other.srcWidth && srcHeight == other.srcHeight && srcFormat == other.srcFormat &&
+           colorspace == other.colorspace && range == other.range &&
+           dstWidth == other.dstWidth && dstHeight == other.dstHeight && dstFormat == other.dstFormat;
+}
+
+bool ConvertKey::operator!=(const ConvertKey& other) const {
+    return !(*this == other);
+}
+
+ConvertPlan::~ConvertPlan() {
+    sws_free_context(&scaler);
+    for (SwsContext* ctx : swsSlices) {
+        sws_freeContext(ctx);
+    }
+}
+
+int ConvertPlan::getSliceCount() const {
+    return sliceRows.empty() ? 0 : (int) sliceRows.size() - 1;
+}
+
+const char* ConvertPlan::getKernelName() const {
+    if (scaler) return "sws_scale_frame";
+    return useYuvConverter ? yuvConverter.getKernelName() : "sws_scale";
+}
+
+SwsCache::SwsCache(size_t cap) : capacity(std::max<size_t>(1, cap)) {}
+
+SwsCache::~SwsCache() {
+    for (ConvertPlan* plan : entries) {
+        delete plan;
+    }
+}
+
+ConvertPlan* SwsCache::acquire(const ConvertKey& key, int maxSlices) {
+    for (auto it = entries.begin(); it != entries.end(); ++it) {
+        if ((*it)->key == key) {
+            ConvertPlan* plan = *it;
+            entries.splice(entries.begin(), entries, it);
+            hits++;
+            LOGI("♻️ Convert plan hit: %dx%d %s", key.srcWidth, key.srcHeight, av_get_pix_fmt_name(key.srcFormat));
+            return plan;
+        }
+    }
+
+    misses++;
+    ConvertPlan* plan = createPlan(key, maxSlices);
+    if (!plan) return nullptr;
+
+    entries.push_front(plan);
+    if (entries.size() > capacity) {
+        delete entries.back();
+        entries.pop_back();
+    }
+    return plan;
+}
+
+ConvertPlan* SwsCache::createPlan(const ConvertKey& key, int maxSlices) {
+    const AVPixFmtDescriptor* desc = av_pix_fmt_desc_get(key.srcFormat);
+    if (!desc) {
+        LOGE("❌ Unknown source pixel format %d", key.srcFormat);
+        return nullptr;
+    }
+
+    ConvertPlan* plan = new ConvertPlan();
+    plan->key = key;
+    plan->chromaShift = desc->log2_chroma_h;
+    plan->rgbPlanes = desc->flags & AV_PIX_FMT_FLAG_RGB;
+
+    // 缩放到显示尺寸：条带之间有垂直滤波依赖，整帧作为一个条带；不开 swscale 自己的线程，
+    // 多个播放器时每个缩放上下文各带一组线程会超额占用核心
+    if (key.dstWidth != key.srcWidth || key.dstHeight != key.srcHeight) {
+        plan->scaler = sws_alloc_context();
+        if (!plan->scaler) {
+            delete plan;
+            return nullptr;
+        }
+        plan->scaler->flags = SWS_FAST_BILINEAR;
+        plan->scaler->threads = 1;
+        plan->sliceRows = {0, key.srcHeight};
+
+        LOGI("🧩 Convert plan %dx%d %s -> %dx%d %s: %s, 1 slice",
+             key.srcWidth, key.srcHeight, desc->name, key.dstWidth, key.dstHeight,
+             av_get_pix_fmt_name(key.dstFormat), plan->getKernelName());
+        return plan;
+    }
+
+    // 1080p 以下单线程已经足够，更大的帧才拆成多个条带
+    int64_t pixels = (int64_t) key.srcWidth * key.srcHeight;
+    int slices = 1;
+    if (pixels > 1920 * 1088) slices = maxSlices;
+    else if (pixels > 1280 * 720) slices = std::min(2, maxSlices);
+    if (desc->flags & AV_PIX_FMT_FLAG_PAL) slices = 1;
+
+    // 条带边界按 16 行对齐，保证色度行不跨条带
+    int rowsPerSlice = FFALIGN((key.srcHeight + slices - 1) / slices, 16);
+    for (int y = 0; y < key.srcHeight; y += rowsPerSlice) {
+        plan->sliceRows.push_back(y);
+    }
+    plan->sliceRows.push_back(key.srcHeight);
+
+    plan->useYuvConverter = plan->yuvConverter.init(key.srcFormat, key.dstFormat, key.colorspace, key.range,
+                                                    key.srcWidth);
+    if (!plan->useYuvConverter) {
+        int srcRange = key.range == AVCOL_RANGE_JPEG ? 1 : 0;
+        for (int i = 0; i < plan->getSliceCount(); i++) {
+            int h = plan->sliceRows[i + 1] - plan->sliceRows[i];
+            SwsContext* ctx = sws_getContext(key.srcWidth, h, key.srcFormat,
+                                             key.dstWidth, h, key.dstFormat,
+                                             SWS_POINT, nullptr, nullptr, nullptr);
+            if (!ctx) {
+                LOGE("❌ Failed to create SwsContext for slice %d", i);
+                delete plan;
+                return nullptr;
+            }
+            sws_setColorspaceDetails(ctx, sws_getCoefficients(key.colorspace), srcRange,
+                                     sws_getCoefficients(SWS_CS_DEFAULT), 1, 0, 1 << 16, 1 << 16);
+            plan->swsSlices.push_back(ctx);
+        }
+    }
+
+    LOGI("🧩 Convert plan %dx%d %s -> %dx%d %s: %s, %d slice(s)",
+         key.srcWidth, key.srcHeight, desc->name, key.dstWidth, key.dstHeight,
+         av_get_pix_fmt_name(key.dstFormat), plan->getKernelName(), plan->getSliceCount());
+    return plan;
+}
+
+int64_t SwsCache::getHits() const {
+    return hits;
+}
+
+int64_t SwsCache::getMisses() const {
+    return misses;
+}
@@ -0,0 +1,186 @@
+//
+// taskScheduler.cpp
+//
+
+#include "taskScheduler.h"
+#include "threadPolicy.h"
+#include "log.h"
+#define TAG "taskScheduler"
+
+#include <algorithm>
+
+// 当前线程在调度器中的编号，不是工作线程时为 -1
+static thread_local int currentWorker = -1;
+
+void Task::wake() {
+    int s = state.load();
+    while (true) {
+        if (s == Idle) {
+            if (state.compare_exchange_weak(s, Queued)) {
+                TaskScheduler::instance().submit(shared_from_this());
+                return;
+            }
+        } else if (s == Running) {
+            if (state.compare_exchange_weak(s, Notified)) return;
+        } else {
+            return;  // 已在队列中、已被通知或已结束
+        }
+    }
+}
+
+void Task::wakeAfter(double seconds) {
+    TaskScheduler::instance().submitAfter(shared_from_this(), seconds);
+}
+
+void Task::join() {
+    std::unique_lock<std::mutex> lock(doneMtx);
+    doneCond.wait(lock, [this] { return state.load() == Finished; });
+}
+
+TaskScheduler& TaskScheduler::instance() {
+    static TaskScheduler scheduler(std::max(2, getCpuTopology().totalCores));
+    return scheduler;
+}
+
+TaskScheduler::TaskScheduler(int threadCount) {
+    for (int i = 0; i < threadCount; i++) {
+        workers.emplace_back(new Worker());
+    }
+    for (int i = 0; i < threadCount; i++) {
+        threads.emplace_back(&TaskScheduler::workerLoop, this, i);
+    }
+    timerThread = std::thread(&TaskScheduler::timerLoop, this);
+    LOGI("🧵 Task scheduler started with %d workers", threadCount);
+}
+
+TaskScheduler::~TaskScheduler() {
+    {
+        std::lock_guard<std::mutex> lock(idleMtx);
+        stopping = true;
+    }
+    idleCond.notify_all();
+    {
+        std::lock_guard<std::mutex> lock(timerMtx);
+        timerCond.notify_all();
+    }
+    for (auto& thread : threads) {
+        if (thread.joinable()) thread.join();
+    }
+    if (timerThread.joinable()) timerThread.join();
+}
+
+int TaskScheduler::size() const {
+    return (int) workers.size();
+}
+
+void TaskScheduler::submit(std::shared_ptr<Task> task) {
+    // 工作线程唤醒的任务放进自己的队列，数据还在缓存里；其他线程提交的轮流分配
+    int self = currentWorker;
+    Worker& worker = *workers[self >= 0 ? self : nextWorker++ % workers.size()];
+    {
+        std::lock_guard<std::mutex> lock(worker.mtx);
+        worker.tasks.push_back(std::move(task));
+    }
+    pending++;
+    {
+        std::lock_guard<std::mutex> lock(idleMtx);
+    }
+    idleCond.notify_one();
+}
+
+void TaskScheduler::submitAfter(std::shared_ptr<Task> task, double seconds) {
+    auto due = Clock::now() + std::chrono::microseconds((int64_t) (std::max(0.0, seconds) * 1e6));
+    std::lock_guard<std::mutex> lock(timerMtx);
+    bool earliest = timers.empty() || due < timers.top().due;
+    timers.push({due, std::move(task)});
+    if (earliest) timerCond.notify_one();
+}
+
+std::shared_ptr<Task> TaskScheduler::take(int self) {
+    std::shared_ptr<Task> task;
+    {
+        // 自己的队列从尾部取（最近唤醒的）
+        Worker& own = *workers[self];
+        std::lock_guard<std::mutex> lock(own.mtx);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+        }
+    }
+    // 从其他线程的队列头部偷最早排队的
+    for (size_t i = 1; !task && i < workers.size(); i++) {
+        Worker& victim = *workers[(self + i) % workers.size()];
+        std::lock_guard<std::mutex> lock(victim.mtx);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+        }
+    }
+    if (task) pending--;
+    return task;
+}
+
+void TaskScheduler::run(const std::shared_ptr<Task>& task) {
+    task->state = Task::Running;
+    Task::Status status = task->step();
+
+    if (status == Task::Status::Done) {
+        std::lock_guard<std::mutex> lock(task->doneMtx);
+        task->state = Task::Finished;
+        task->doneCond.notify_all();
+        return;
+    }
+
+    int expected = Task::Running;
+    if (status == Task::Status::Blocked && task->state.compare_exchange_strong(expected, Task::Idle)) return;
+
+    // 让出，或者执行期间被 wake 过：重新排队。放到自己队列的头部，先执行队列里的其他任务
+    task->state = Task::Queued;
+    Worker& own = *workers[currentWorker];
+    {
+        std::lock_guard<std::mutex> lock(own.mtx);
+        own.tasks.push_front(task);
+    }
+    pending++;
+}
+
+void TaskScheduler::workerLoop(int self) {
+    currentWorker = self;
+    while (true) {
+        std::shared_ptr<Task> task = take(self);
+        if (task) {
+            run(task);
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(idleMtx);
+        idleCond.wait(lock, [this] { return stopping || pending.load() > 0; });
+        if (stopping) return;
+    }
+}
+
+void TaskScheduler::timerLoop() {
+    std::unique_lock<std::mutex> lock(timerMtx);
+    while (true) {
+        {
+            std::lock_guard<std::mutex> idleLock(idleMtx);
+            if (stopping) return;
+        }
+        if (timers.empty()) {
+            timerCond.wait(lock);
+            continue;
+        }
+        if (timerCond.wait_until(lock, timers.top().due) == std::cv_status::no_timeout) continue;
+
+        // 到期的任务在锁外唤醒，wake 可能再调用 submitAfter
+        std::vector<std::shared_ptr<Task>> due;
+        auto now = Clock::now();
+        while (!timers.empty() && timers.top().due <= now) {
+            due.push_back(timers.top().task);
+            timers.pop();
+        }
+        lock.unlock();
+        for (auto& task : due) task->wake();
+        due.clear();
+        lock.lock();
+    }
+}
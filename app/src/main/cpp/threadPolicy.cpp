@@ -0,0 +1,128 @@
+//
+// threadPolicy.cpp
+//
+
+#include "threadPolicy.h"
+#include "log.h"
+#define TAG "threadPolicy"
+
+extern "C" {
+#include <libavutil/pixdesc.h>
+}
+
+#include <algorithm>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+
+static long readMaxFreq(int cpu) {
+    char path[128];
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/cpufreq/cpuinfo_max_freq", cpu);
+    FILE* f = fopen(path, "r");
+    if (!f) return 0;
+    long freq = 0;
+    if (fscanf(f, "%ld", &freq) != 1) freq = 0;
+    fclose(f);
+    return freq;
+}
+
+const CpuTopology& getCpuTopology() {
+    static CpuTopology topology;
+    static std::once_flag once;
+
+    std::call_once(once, [] {
+        std::vector<long> freqs;
+        for (int i = 0; ; i++) {
+            char path[64];
+            snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d", i);
+            if (access(path, F_OK) != 0) break;
+            freqs.push_back(readMaxFreq(i));  // 离线核心读不到频率，记为 0
+        }
+
+        if (freqs.empty()) {
+            topology.totalCores = std::max(1u, std::thread::hardware_concurrency());
+            topology.bigCores = topology.totalCores;
+            LOGI("🧮 CPU topology unavailable, assuming %d cores", topology.totalCores);
+            return;
+        }
+
+        long maxFreq = *std::max_element(freqs.begin(), freqs.end());
+        long minFreq = maxFreq;
+        for (long f : freqs) {
+            if (f > 0) minFreq = std::min(minFreq, f);
+        }
+
+        topology.totalCores = (int) freqs.size();
+        for (long f : freqs) {
+            // 只有一个频率簇时全部算作大核
+            if (minFreq < maxFreq && f <= minFreq) topology.littleCores++;
+            else topology.bigCores++;
+        }
+        LOGI("🧮 CPU topology: %d cores, big=%d little=%d (max %ld kHz, min %ld kHz)",
+             topology.totalCores, topology.bigCores, topology.littleCores, maxFreq, minFreq);
+    });
+
+    return topology;
+}
+
+// 高位深或非 4:2:0 的 profile 每帧解码量明显更大
+static bool isHeavyProfile(const AVCodecParameters* codecpar) {
+    const AVPixFmtDescriptor* desc = av_pix_fmt_desc_get((AVPixelFormat) codecpar->format);
+    if (desc) {
+        return desc->comp[0].depth > 8 || desc->log2_chroma_h == 0;
+    }
+    switch (codecpar->codec_id) {
+        case AV_CODEC_ID_H264:
+            return codecpar->profile >= AV_PROFILE_H264_HIGH_10;
+        case AV_CODEC_ID_HEVC:
+            return codecpar->profile == AV_PROFILE_HEVC_MAIN_10 || codecpar->profile == AV_PROFILE_HEVC_REXT;
+        default:
+            return false;
+    }
+}
+
+ThreadDecision chooseDecodeThreading(const AVCodec* codec, const AVCodecParameters* codecpar,
+                                     bool lowLatency) {
+    ThreadDecision decision;
+    const CpuTopology& cpu = getCpuTopology();
+
+    bool canFrame = codec->capabilities & AV_CODEC_CAP_FRAME_THREADS;
+    bool canSlice = codec->capabilities & AV_CODEC_CAP_SLICE_THREADS;
+    if (!canFrame && !canSlice) {
+        LOGI("🧵 %s: no threading support, single thread", codec->name);
+        return decision;
+    }
+
+    int64_t pixels = (int64_t) codecpar->width * codecpar->height;
+    int wanted;
+    if (pixels <= 854 * 480) wanted = 2;
+    else if (pixels <= 1280 * 720) wanted = 3;
+    else if (pixels <= 1920 * 1088) wanted = 4;
+    else wanted = 6;
+    if (isHeavyProfile(codecpar)) wanted += 2;
+
+    // 1080p 及以下只占用大核，更高分辨率才把小核也算进来
+    int available = pixels <= 1920 * 1088 ? cpu.bigCores : cpu.totalCores;
+    if (available <= 0) available = cpu.totalCores;
+    decision.threadCount = std::max(1, std::min({wanted, available, 16}));
+
+    // frame 线程每多一个线程就多一帧延迟，低延迟模式优先 slice
+    if ((lowLatency && canSlice) || !canFrame) {
+        decision.threadType = FF_THREAD_SLICE;
+    } else {
+        decision.threadType = FF_THREAD_FRAME;
+    }
+
+    LOGI("🧵 %s %dx%d profile=%d%s: %s threads x%d",
+         codec->name, codecpar->width, codecpar->height, codecpar->profile,
+         lowLatency ? " (low latency)" : "",
+         decision.threadType == FF_THREAD_FRAME ? "frame" : "slice", decision.threadCount);
+    return decision;
+}
+
+void applyDecodeThreading(AVCodecContext* codecCtx, const ThreadDecision& decision) {
+    codecCtx->thread_type = decision.threadType;
+    codecCtx->thread_count = decision.threadCount;
+}
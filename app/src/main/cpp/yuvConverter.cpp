@@ -0,0 +1,318 @@
+//
+// yuvConverter.cpp
+//
+
+#include "yuvConverter.h"
+#include "log.h"
+#define TAG "yuvConverter"
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define YUV_X86 1
+#endif
+
+// Q6 定点系数：{yOffset, yMul, vr, ug, vg, ub}
+static const YuvCoeffs bt601Limited = {16, 75, 102, 25, 52, 129};
+static const YuvCoeffs bt709Limited = {16, 75, 115, 14, 34, 135};
+static const YuvCoeffs bt601Full    = {0, 64, 90, 22, 46, 113};
+static const YuvCoeffs bt709Full    = {0, 64, 101, 12, 30, 119};
+
+static inline uint8_t clampU8(int v) {
+    return v < 0 ? 0 : v > 255 ? 255 : (uint8_t) v;
+}
+
+// 标量实现，同时用于 SIMD 行尾剩余像素，算法与 SIMD 完全一致
+template <bool RGB565>
+static void convertPixels(const uint8_t* y, const uint8_t* u, const uint8_t* v, uint8_t* dst,
+                          int start, int width, YuvConverter::Layout layout, const YuvCoeffs* c) {
+    for (int x = start; x < width; x++) {
+        int cx = x / 2;
+        int cu, cv;
+        if (layout == YuvConverter::LAYOUT_I420) {
+            cu = u[cx];
+            cv = v[cx];
+        } else if (layout == YuvConverter::LAYOUT_NV12) {
+            cu = u[cx * 2];
+            cv = u[cx * 2 + 1];
+        } else {
+            cv = u[cx * 2];
+            cu = u[cx * 2 + 1];
+        }
+        int du = cu - 128;
+        int dv = cv - 128;
+        int yt = (y[x] - c->yOffset) * c->yMul + 32;
+
+        uint8_t r = clampU8((yt + c->vr * dv) >> 6);
+        uint8_t g = clampU8((yt - c->ug * du - c->vg * dv) >> 6);
+        uint8_t b = clampU8((yt + c->ub * du) >> 6);
+
+        if (RGB565) {
+            ((uint16_t*) dst)[x] = (uint16_t) (((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3));
+        } else {
+            dst[x * 4] = r;
+            dst[x * 4 + 1] = g;
+            dst[x * 4 + 2] = b;
+            dst[x * 4 + 3] = 255;
+        }
+    }
+}
+
+template <bool RGB565>
+static void rowScalar(const uint8_t* y, const uint8_t* u, const uint8_t* v, uint8_t* dst,
+                      int width, YuvConverter::Layout layout, const YuvCoeffs* c) {
+    convertPixels<RGB565>(y, u, v, dst, 0, width, layout, c);
+}
+
+#if defined(__ARM_NEON)
+
+template <bool RGB565>
+static void rowNeon(const uint8_t* y, const uint8_t* u, const uint8_t* v, uint8_t* dst,
+                    int width, YuvConverter::Layout layout, const YuvCoeffs* c) {
+    const int16x8_t yOff = vdupq_n_s16(c->yOffset);
+    const int16x8_t yMul = vdupq_n_s16(c->yMul);
+    const int16x8_t round = vdupq_n_s16(32);
+    const int16x8_t bias = vdupq_n_s16(128);
+    const int16x8_t vr = vdupq_n_s16(c->vr);
+    const int16x8_t ug = vdupq_n_s16(c->ug);
+    const int16x8_t vg = vdupq_n_s16(c->vg);
+    const int16x8_t ub = vdupq_n_s16(c->ub);
+
+    int x = 0;
+    for (; x + 16 <= width; x += 16) {
+        uint8x16_t yv = vld1q_u8(y + x);
+        uint8x8_t u8, v8;
+        if (layout == YuvConverter::LAYOUT_I420) {
+            u8 = vld1_u8(u + x / 2);
+            v8 = vld1_u8(v + x / 2);
+        } else {
+            uint8x8x2_t uv = vld2_u8(u + x);
+            u8 = layout == YuvConverter::LAYOUT_NV12 ? uv.val[0] : uv.val[1];
+            v8 = layout == YuvConverter::LAYOUT_NV12 ? uv.val[1] : uv.val[0];
+        }
+        // 色度水平复制一份，对应两个亮度像素
+        uint8x8x2_t uz = vzip_u8(u8, u8);
+        uint8x8x2_t vz = vzip_u8(v8, v8);
+
+        for (int half = 0; half < 2; half++) {
+            uint8x8_t yh = half ? vget_high_u8(yv) : vget_low_u8(yv);
+            int16x8_t y16 = vreinterpretq_s16_u16(vmovl_u8(yh));
+            int16x8_t u16 = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(uz.val[half])), bias);
+            int16x8_t v16 = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(vz.val[half])), bias);
+
+            int16x8_t yt = vaddq_s16(vmulq_s16(vsubq_s16(y16, yOff), yMul), round);
+            uint8x8_t r8 = vqshrun_n_s16(vqaddq_s16(yt, vmulq_s16(v16, vr)), 6);
+            uint8x8_t g8 = vqshrun_n_s16(vqsubq_s16(yt, vaddq_s16(vmulq_s16(u16, ug), vmulq_s16(v16, vg))), 6);
+            uint8x8_t b8 = vqshrun_n_s16(vqaddq_s16(yt, vmulq_s16(u16, ub)), 6);
+
+            if (RGB565) {
+                uint16x8_t p = vorrq_u16(
+                        vorrq_u16(vshlq_n_u16(vmovl_u8(vand_u8(r8, vdup_n_u8(0xF8))), 8),
+                                  vshlq_n_u16(vmovl_u8(vand_u8(g8, vdup_n_u8(0xFC))), 3)),
+                        vmovl_u8(vshr_n_u8(b8, 3)));
+                vst1q_u16((uint16_t*) (dst + (x + half * 8) * 2), p);
+            } else {
+                uint8x8x4_t px = {{r8, g8, b8, vdup_n_u8(255)}};
+                vst4_u8(dst + (x + half * 8) * 4, px);
+            }
+        }
+    }
+    convertPixels<RGB565>(y, u, v, dst, x, width, layout, c);
+}
+
+#endif
+
+#if YUV_X86
+
+// 16 字节色度 -> 每个样本复制两份的 16 字节
+__attribute__((target("sse4.1")))
+static inline void loadChromaSse(const uint8_t* u, const uint8_t* v, int x, YuvConverter::Layout layout,
+                                 __m128i& uDup, __m128i& vDup) {
+    const __m128i dupLow = _mm_setr_epi8(0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7);
+    const __m128i dupEven = _mm_setr_epi8(0, 0, 2, 2, 4, 4, 6, 6, 8, 8, 10, 10, 12, 12, 14, 14);
+    const __m128i dupOdd = _mm_setr_epi8(1, 1, 3, 3, 5, 5, 7, 7, 9, 9, 11, 11, 13, 13, 15, 15);
+
+    if (layout == YuvConverter::LAYOUT_I420) {
+        uDup = _mm_shuffle_epi8(_mm_loadl_epi64((const __m128i*) (u + x / 2)), dupLow);
+        vDup = _mm_shuffle_epi8(_mm_loadl_epi64((const __m128i*) (v + x / 2)), dupLow);
+    } else {
+        __m128i uv = _mm_loadu_si128((const __m128i*) (u + x));
+        bool nv12 = layout == YuvConverter::LAYOUT_NV12;
+        uDup = _mm_shuffle_epi8(uv, nv12 ? dupEven : dupOdd);
+        vDup = _mm_shuffle_epi8(uv, nv12 ? dupOdd : dupEven);
+    }
+}
+
+template <bool RGB565>
+__attribute__((target("sse4.1")))
+static void rowSse41(const uint8_t* y, const uint8_t* u, const uint8_t* v, uint8_t* dst,
+                     int width, YuvConverter::Layout layout, const YuvCoeffs* c) {
+    const __m128i yOff = _mm_set1_epi16(c->yOffset);
+    const __m128i yMul = _mm_set1_epi16(c->yMul);
+    const __m128i round = _mm_set1_epi16(32);
+    const __m128i bias = _mm_set1_epi16(128);
+    const __m128i vr = _mm_set1_epi16(c->vr);
+    const __m128i ug = _mm_set1_epi16(c->ug);
+    const __m128i vg = _mm_set1_epi16(c->vg);
+    const __m128i ub = _mm_set1_epi16(c->ub);
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i max = _mm_set1_epi16(255);
+    const __m128i alpha = _mm_set1_epi16((short) 0xFF00);
+    const __m128i maskR = _mm_set1_epi16(0xF8);
+    const __m128i maskG = _mm_set1_epi16(0xFC);
+
+    int x = 0;
+    for (; x + 16 <= width; x += 16) {
+        __m128i yv = _mm_loadu_si128((const __m128i*) (y + x));
+        __m128i uDup, vDup;
+        loadChromaSse(u, v, x, layout, uDup, vDup);
+
+        for (int half = 0; half < 2; half++) {
+            __m128i y16 = _mm_cvtepu8_epi16(half ? _mm_srli_si128(yv, 8) : yv);
+            __m128i u16 = _mm_sub_epi16(_mm_cvtepu8_epi16(half ? _mm_srli_si128(uDup, 8) : uDup), bias);
+            __m128i v16 = _mm_sub_epi16(_mm_cvtepu8_epi16(half ? _mm_srli_si128(vDup, 8) : vDup), bias);
+
+            __m128i yt = _mm_add_epi16(_mm_mullo_epi16(_mm_sub_epi16(y16, yOff), yMul), round);
+            __m128i r = _mm_srai_epi16(_mm_adds_epi16(yt, _mm_mullo_epi16(v16, vr)), 6);
+            __m128i g = _mm_srai_epi16(_mm_subs_epi16(yt, _mm_add_epi16(_mm_mullo_epi16(u16, ug),
+                                                                        _mm_mullo_epi16(v16, vg))), 6);
+            __m128i b = _mm_srai_epi16(_mm_adds_epi16(yt, _mm_mullo_epi16(u16, ub)), 6);
+            r = _mm_min_epi16(_mm_max_epi16(r, zero), max);
+            g = _mm_min_epi16(_mm_max_epi16(g, zero), max);
+            b = _mm_min_epi16(_mm_max_epi16(b, zero), max);
+
+            if (RGB565) {
+                __m128i p = _mm_or_si128(_mm_or_si128(_mm_slli_epi16(_mm_and_si128(r, maskR), 8),
+                                                      _mm_slli_epi16(_mm_and_si128(g, maskG), 3)),
+                                         _mm_srli_epi16(b, 3));
+                _mm_storeu_si128((__m128i*) (dst + (x + half * 8) * 2), p);
+            } else {
+                __m128i rg = _mm_or_si128(r, _mm_slli_epi16(g, 8));
+                __m128i ba = _mm_or_si128(b, alpha);
+                uint8_t* out = dst + (x + half * 8) * 4;
+                _mm_storeu_si128((__m128i*) out, _mm_unpacklo_epi16(rg, ba));
+                _mm_storeu_si128((__m128i*) (out + 16), _mm_unpackhi_epi16(rg, ba));
+            }
+        }
+    }
+    convertPixels<RGB565>(y, u, v, dst, x, width, layout, c);
+}
+
+template <bool RGB565>
+__attribute__((target("avx2")))
+static void rowAvx2(const uint8_t* y, const uint8_t* u, const uint8_t* v, uint8_t* dst,
+                    int width, YuvConverter::Layout layout, const YuvCoeffs* c) {
+    const __m256i yOff = _mm256_set1_epi16(c->yOffset);
+    const __m256i yMul = _mm256_set1_epi16(c->yMul);
+    const __m256i round = _mm256_set1_epi16(32);
+    const __m256i bias = _mm256_set1_epi16(128);
+    const __m256i vr = _mm256_set1_epi16(c->vr);
+    const __m256i ug = _mm256_set1_epi16(c->ug);
+    const __m256i vg = _mm256_set1_epi16(c->vg);
+    const __m256i ub = _mm256_set1_epi16(c->ub);
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i max = _mm256_set1_epi16(255);
+    const __m256i alpha = _mm256_set1_epi16((short) 0xFF00);
+    const __m256i maskR = _mm256_set1_epi16(0xF8);
+    const __m256i maskG = _mm256_set1_epi16(0xFC);
+
+    int x = 0;
+    for (; x + 16 <= width; x += 16) {
+        __m128i uDup, vDup;
+        loadChromaSse(u, v, x, layout, uDup, vDup);
+
+        // 16 个像素各占一个 16 位通道，顺序与内存一致
+        __m256i y16 = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*) (y + x)));
+        __m256i u16 = _mm256_sub_epi16(_mm256_cvtepu8_epi16(uDup), bias);
+        __m256i v16 = _mm256_sub_epi16(_mm256_cvtepu8_epi16(vDup), bias);
+
+        __m256i yt = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_sub_epi16(y16, yOff), yMul), round);
+        __m256i r = _mm256_srai_epi16(_mm256_adds_epi16(yt, _mm256_mullo_epi16(v16, vr)), 6);
+        __m256i g = _mm256_srai_epi16(_mm256_subs_epi16(yt, _mm256_add_epi16(_mm256_mullo_epi16(u16, ug),
+                                                                             _mm256_mullo_epi16(v16, vg))), 6);
+        __m256i b = _mm256_srai_epi16(_mm256_adds_epi16(yt, _mm256_mullo_epi16(u16, ub)), 6);
+        r = _mm256_min_epi16(_mm256_max_epi16(r, zero), max);
+        g = _mm256_min_epi16(_mm256_max_epi16(g, zero), max);
+        b = _mm256_min_epi16(_mm256_max_epi16(b, zero), max);
+
+        if (RGB565) {
+            __m256i p = _mm256_or_si256(_mm256_or_si256(_mm256_slli_epi16(_mm256_and_si256(r, maskR), 8),
+                                                        _mm256_slli_epi16(_mm256_and_si256(g, maskG), 3)),
+                                        _mm256_srli_epi16(b, 3));
+            _mm256_storeu_si256((__m256i*) (dst + x * 2), p);
+        } else {
+            __m256i rg = _mm256_or_si256(r, _mm256_slli_epi16(g, 8));
+            __m256i ba = _mm256_or_si256(b, alpha);
+            // unpack 按 128 位分道进行，需要再把两道拼回像素顺序
+            __m256i lo = _mm256_unpacklo_epi16(rg, ba);
+            __m256i hi = _mm256_unpackhi_epi16(rg, ba);
+            _mm256_storeu_si256((__m256i*) (dst + x * 4), _mm256_permute2x128_si256(lo, hi, 0x20));
+            _mm256_storeu_si256((__m256i*) (dst + x * 4 + 32), _mm256_permute2x128_si256(lo, hi, 0x31));
+        }
+    }
+    convertPixels<RGB565>(y, u, v, dst, x, width, layout, c);
+}
+
+#endif
+
+bool YuvConverter::isSupported(AVPixelFormat src, AVPixelFormat dst) {
+    bool srcOk = src == AV_PIX_FMT_YUV420P || src == AV_PIX_FMT_YUVJ420P ||
+                 src == AV_PIX_FMT_NV12 || src == AV_PIX_FMT_NV21;
+    bool dstOk = dst == AV_PIX_FMT_RGBA || dst == AV_PIX_FMT_RGB565;
+    return srcOk && dstOk;
+}
+
+bool YuvConverter::init(AVPixelFormat src, AVPixelFormat dst, AVColorSpace colorspace, AVColorRange range,
+                        int width, bool simd) {
+    if (!isSupported(src, dst)) {
+        rowFunc = nullptr;
+        return false;
+    }
+
+    layout = src == AV_PIX_FMT_NV12 ? LAYOUT_NV12 : src == AV_PIX_FMT_NV21 ? LAYOUT_NV21 : LAYOUT_I420;
+
+    bool fullRange = range == AVCOL_RANGE_JPEG || src == AV_PIX_FMT_YUVJ420P;
+    bool bt709 = colorspace == AVCOL_SPC_BT709 || (colorspace == AVCOL_SPC_UNSPECIFIED && width >= 1280);
+    if (bt709) coeffs = fullRange ? bt709Full : bt709Limited;
+    else coeffs = fullRange ? bt601Full : bt601Limited;
+
+    bool rgb565 = dst == AV_PIX_FMT_RGB565;
+    rowFunc = rgb565 ? rowScalar<true> : rowScalar<false>;
+    kernelName = "scalar";
+#if defined(__ARM_NEON)
+    if (simd) {
+        rowFunc = rgb565 ? rowNeon<true> : rowNeon<false>;
+        kernelName = "neon";
+    }
+#elif YUV_X86
+    if (simd && __builtin_cpu_supports("avx2")) {
+        rowFunc = rgb565 ? rowAvx2<true> : rowAvx2<false>;
+        kernelName = "avx2";
+    } else if (simd && __builtin_cpu_supports("sse4.1")) {
+        rowFunc = rgb565 ? rowSse41<true> : rowSse41<false>;
+        kernelName = "sse4.1";
+    }
+#endif
+
+    LOGI("🎨 YuvConverter: %s -> %s, %s %s range, kernel=%s",
+         av_get_pix_fmt_name(src), av_get_pix_fmt_name(dst),
+         bt709 ? "BT.709" : "BT.601", fullRange ? "full" : "limited", kernelName);
+    return true;
+}
+
+void YuvConverter::convert(const AVFrame* src, AVFrame* dst, int rowStart, int rowEnd) const {
+    for (int row = rowStart; row < rowEnd; row++) {
+        int chromaRow = row / 2;
+        const uint8_t* yRow = src->data[0] + (ptrdiff_t) row * src->linesize[0];
+        const uint8_t* uRow = src->data[1] + (ptrdiff_t) chromaRow * src->linesize[1];
+        const uint8_t* vRow = layout == LAYOUT_I420 ? src->data[2] + (ptrdiff_t) chromaRow * src->linesize[2]
+                                                    : nullptr;
+        uint8_t* out = dst->data[0] + (ptrdiff_t) row * dst->linesize[0];
+        rowFunc(yRow, uRow, vRow, out, src->width, layout, &coeffs);
+    }
+}
+
+const char* YuvConverter::getKernelName() const {
+    return kernelName;
+}
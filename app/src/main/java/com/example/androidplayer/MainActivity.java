@@ -3,6 +3,7 @@ package com.example.androidplayer;
 import androidx.annotation.NonNull;
 import androidx.appcompat.app.AppCompatActivity;
 
+import android.content.ComponentCallbacks2;
 import android.content.Context;
 import android.content.Intent;
 import android.os.Build;
@@ -13,6 +14,7 @@ import android.os.Looper;
 import android.os.Message;
 import android.provider.Settings;
 import android.util.Log;
+import android.view.Display;
 import android.view.SurfaceHolder;
 import android.view.SurfaceView;
 import android.widget.Button;
@@ -56,6 +58,8 @@ public class MainActivity extends AppCompatActivity {
             }
         };
 
+        Player.setCacheDir(getCacheDir().getAbsolutePath());
+        Player.setStandbyCache(2, 64);
         player = new Player();
         player.setDataSource("file:/sdcard/testfile.mp4");
 
@@ -67,6 +71,12 @@ public class MainActivity extends AppCompatActivity {
                     return;
                 }
                 player.setSurface(holder.getSurface());
+                Display display = findViewById(R.id.surfaceView).getDisplay();
+                if (display != null) {
+                    player.setDisplayRefreshRate(display.getRefreshRate());
+                }
+                // 有 surface 就开始预滚动，点播放时第一帧已经准备好
+                player.prepare();
             }
 
             @Override
@@ -76,7 +86,8 @@ public class MainActivity extends AppCompatActivity {
 
             @Override
             public void surfaceDestroyed(@NonNull SurfaceHolder holder) {
-
+                // 进入后台或重建 Surface：只分离输出，解码状态和音频保留
+                player.setSurface(null);
             }
         });
 
@@ -98,6 +109,8 @@ public class MainActivity extends AppCompatActivity {
             switch (player.getState()) {
                 case None:
                 case End:
+                case Preparing:
+                case Prepared:
                     player.start();
                     if (!progressThread.isAlive())
                         progressThread.start();
@@ -155,16 +168,46 @@ public class MainActivity extends AppCompatActivity {
 
             @Override
             public void onStartTrackingTouch(SeekBar seekBar) {
-
+                player.beginScrub();
             }
 
             @Override
             public void onStopTrackingTouch(SeekBar seekBar) {
-
+                player.endScrub((double) seekBar.getProgress() / 100);
             }
         });
     }
 
+    // 进入后台只播放音频，回到前台时视频跳到当前音频位置继续
+    @Override
+    protected void onStart() {
+        super.onStart();
+        player.setAudioOnly(false);
+    }
+
+    @Override
+    protected void onStop() {
+        player.setAudioOnly(true);
+        super.onStop();
+    }
+
+    // 系统内存紧张时释放热备缓存：前台吃紧或进程可能被杀时全部释放，否则只留最近一个
+    @Override
+    public void onTrimMemory(int level) {
+        super.onTrimMemory(level);
+        if (level == ComponentCallbacks2.TRIM_MEMORY_RUNNING_CRITICAL || level >= ComponentCallbacks2.TRIM_MEMORY_MODERATE) {
+            Player.trimStandby(0);
+        } else if (level == ComponentCallbacks2.TRIM_MEMORY_RUNNING_LOW || level == ComponentCallbacks2.TRIM_MEMORY_BACKGROUND) {
+            Player.trimStandby(1);
+        }
+    }
+
+    @Override
+    protected void onDestroy() {
+        player.release();
+        super.onDestroy();
+    }
+
     private void setSeekBar(int progress) {
         Bundle bundle = new Bundle();
         bundle.putInt("progress", progress);
@@ -1,4 +1,6 @@
 package com.example.androidplayer;
+import android.os.Handler;
+import android.os.Looper;
 import android.view.Surface;
 
 import androidx.core.util.Pair;
@@ -9,6 +11,8 @@ public class Player {
     private long nativeContext;
     public enum PlayerState {
         None,
+        Preparing,
+        Prepared,
         Playing,
         Paused,
         End,
@@ -18,16 +22,58 @@ public class Player {
     private PlayerState mState = PlayerState.None;
     private String fileUri;
     private double duration;
+    private OnPreparedListener mOnPreparedListener;
+    private final Handler mHandler = new Handler(Looper.getMainLooper());
+
+    // prepare 完成（result == 0）或失败时在主线程回调
+    public interface OnPreparedListener {
+        void onPrepared(Player player, int result);
+    }
+    public void setOnPreparedListener(OnPreparedListener listener) {
+        mOnPreparedListener = listener;
+    }
     public void setDataSource(String uri) {
         fileUri = uri;
     }
+    // 播放中（包括准备中和暂停）直接换 Surface，不用重新 prepare；null 表示分离，音频继续播放
     public void setSurface(Surface surface) {
         mSurface = surface;
+        if (mState != PlayerState.None && mState != PlayerState.End) {
+            nativeSetSurface(surface);
+        }
+    }
+    // 应用缓存目录，用来保存编译好的 GL 程序，之后启动跳过着色器编译
+    public static void setCacheDir(String dir) {
+        nativeSetCacheDir(dir);
+    }
+    // stop 之后保留最近播放过的 entries 个本地文件（已探测的输入、解码器和开头的一个 GOP），总共不超过 megabytes，
+    // 再次播放同一个文件只需要一次定位；默认关闭
+    public static void setStandbyCache(int entries, int megabytes) {
+        nativeSetStandbyCache(entries, megabytes);
     }
+    // 内存紧张时调用，只保留最近的 keep 个
+    public static void trimStandby(int keep) {
+        nativeTrimStandby(keep);
+    }
+    public void setDisplayRefreshRate(float hz) {
+        nativeSetRefreshRate(hz);
+    }
+    // 后台打开文件并预滚动第一帧和第一段音频，完成后回调 OnPreparedListener
+    public void prepare() {
+        if (mState != PlayerState.None && mState != PlayerState.End) return;
+        mState = PlayerState.Preparing;
+        if (nativePrepare(fileUri, mSurface) != 0) {
+            mState = PlayerState.End;
+        }
+    }
+    // 已就绪时下一帧就开始播放；还没 prepare 时先 prepare，就绪后立即播放
     public void start() {
-        nativePlay(fileUri, mSurface);
-        mState = PlayerState.Playing;
-        duration = nativeGetDuration();
+        if (mState == PlayerState.None || mState == PlayerState.End) {
+            prepare();
+        }
+        if (nativeStart() == 0) {
+            mState = PlayerState.Playing;
+        }
     }
     public void pause(boolean p) {
         nativePause(p);
@@ -41,8 +87,36 @@ public class Player {
         nativeStop();
         mState = PlayerState.End;
     }
+    public void release() {
+        nativeRelease();
+        mState = PlayerState.None;
+    }
     public void seek(double position) {
-        nativeSeek(position);
+        nativeSeek(position * duration);
+    }
+    public void hintSeek(double position) {
+        nativeHintSeek(position * duration);
+    }
+    public void beginScrub() {
+        nativeBeginScrub();
+    }
+    public void endScrub(double position) {
+        nativeEndScrub(position * duration);
+    }
+    public void stepForward() {
+        nativeStepForward();
+        mState = PlayerState.Paused;
+    }
+    public void stepBackward() {
+        nativeStepBackward();
+        mState = PlayerState.Paused;
+    }
+    // A-B 循环，和 seek 一样用 0-1 的进度表示位置；只在正放时生效，倒放中设置的区间等切回正放后生效
+    public void setLoop(double start, double end) {
+        nativeSetLoop(start * duration, end * duration);
+    }
+    public void clearLoop() {
+        nativeSetLoop(0, 0);
     }
     public double getProgress() {
         return nativeGetPosition() / duration;
@@ -50,14 +124,51 @@ public class Player {
     public PlayerState getState() {
         return mState;
     }
+    // 纯音频：不再解复用、解码和渲染视频，关闭时视频从当前音频位置继续
+    public void setAudioOnly(boolean audioOnly) {
+        nativeSetAudioOnly(audioOnly);
+    }
+    // prepare 之前设置的正倍速会保留到播放开始；负数（倒放）只能在 prepare 之后设置
     public void setSpeed(float speed) {
         nativeSetSpeed(speed);
     }
-    private native int nativePlay(String file, Surface surface);
+    public String getStats() {
+        return nativeGetStats();
+    }
+    // native 线程调用
+    private void onNativePrepared(int result) {
+        mHandler.post(() -> {
+            if (result == 0) {
+                duration = nativeGetDuration();
+                if (mState == PlayerState.Preparing) mState = PlayerState.Prepared;
+            } else {
+                mState = PlayerState.End;
+            }
+            if (mOnPreparedListener != null) {
+                mOnPreparedListener.onPrepared(this, result);
+            }
+        });
+    }
+    private native int nativePrepare(String file, Surface surface);
+    private native int nativeStart();
     private native void nativePause(boolean p);
+    private static native void nativeSetCacheDir(String dir);
+    private static native void nativeSetStandbyCache(int entries, int megabytes);
+    private static native void nativeTrimStandby(int keep);
+    private native void nativeSetSurface(Surface surface);
+    private native int nativeSetAudioOnly(boolean audioOnly);
+    private native void nativeSetRefreshRate(float hz);
     private native int nativeSeek(double position);
+    private native void nativeHintSeek(double position);
+    private native void nativeBeginScrub();
+    private native int nativeEndScrub(double position);
+    private native int nativeStepForward();
+    private native int nativeStepBackward();
     private native int nativeStop();
+    private native void nativeRelease();
     private native int nativeSetSpeed(float speed);
     private native double nativeGetPosition();
+    private native int nativeSetLoop(double start, double end);
     private native double nativeGetDuration();
+    private native String nativeGetStats();
 }
@@ -0,0 +1,207 @@
+//
+// playbackControlTest.cpp
+// 停止的顺序保证：stop 唤醒所有等待并让它们返回 false，之后不再有预滚动回调，注销的 listener 不再被调用
+//
+
+#include "playbackControl.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <thread>
+
+namespace {
+
+using namespace std::chrono_literals;
+
+// 等待线程先进入阻塞，再在测试线程上触发事件
+const auto settle = 50ms;
+const auto deadline = 2s;
+
+}  // namespace
+
+TEST(PlaybackControlTest, StopWakesWaitWhilePaused) {
+    PlaybackControl control;
+    control.reset();
+    control.setPaused(true);
+
+    auto waiter = std::async(std::launch::async, [&] { return control.waitWhilePaused(control.getSerial()); });
+    ASSERT_EQ(std::future_status::timeout, waiter.wait_for(settle));
+
+    control.stop();
+    ASSERT_EQ(std::future_status::ready, waiter.wait_for(deadline));
+    EXPECT_FALSE(waiter.get());
+}
+
+TEST(PlaybackControlTest, StopWakesWaitUntilResumed) {
+    PlaybackControl control;
+    control.reset();
+    control.setPaused(true);
+
+    auto waiter = std::async(std::launch::async, [&] { return control.waitUntilResumed(); });
+    ASSERT_EQ(std::future_status::timeout, waiter.wait_for(settle));
+
+    control.stop();
+    ASSERT_EQ(std::future_status::ready, waiter.wait_for(deadline));
+    EXPECT_FALSE(waiter.get());
+}
+
+TEST(PlaybackControlTest, StopCutsSleepShort) {
+    PlaybackControl control;
+    control.reset();
+
+    auto start = std::chrono::steady_clock::now();
+    auto sleeper = std::async(std::launch::async, [&] { return control.sleepFor(30.0, control.getSerial()); });
+    std::this_thread::sleep_for(settle);
+
+    control.stop();
+    ASSERT_EQ(std::future_status::ready, sleeper.wait_for(deadline));
+    EXPECT_FALSE(sleeper.get());
+    EXPECT_LT(std::chrono::steady_clock::now() - start, deadline);
+}
+
+TEST(PlaybackControlTest, WaitsAfterStopReturnImmediately) {
+    PlaybackControl control;
+    control.reset();
+    control.setPaused(true);
+    control.stop();
+
+    EXPECT_FALSE(control.waitWhilePaused(control.getSerial()));
+    EXPECT_FALSE(control.waitUntilResumed());
+    EXPECT_FALSE(control.sleepFor(30.0, control.getSerial()));
+    EXPECT_TRUE(control.isStopped());
+    EXPECT_TRUE(control.cancelToken()->isCancelled());
+}
+
+TEST(PlaybackControlTest, SeekWakesPausedWaitWithFalse) {
+    PlaybackControl control;
+    control.reset();
+    control.setPaused(true);
+
+    int serial = control.getSerial();
+    auto waiter = std::async(std::launch::async, [&] { return control.waitWhilePaused(serial); });
+    ASSERT_EQ(std::future_status::timeout, waiter.wait_for(settle));
+
+    control.requestSeek(1.0);
+    ASSERT_EQ(std::future_status::ready, waiter.wait_for(deadline));
+    EXPECT_FALSE(waiter.get());
+}
+
+TEST(PlaybackControlTest, ResumeWakesPausedWaitWithTrue) {
+    PlaybackControl control;
+    control.reset();
+    control.setPaused(true);
+
+    auto waiter = std::async(std::launch::async, [&] { return control.waitWhilePaused(control.getSerial()); });
+    ASSERT_EQ(std::future_status::timeout, waiter.wait_for(settle));
+
+    control.setPaused(false);
+    ASSERT_EQ(std::future_status::ready, waiter.wait_for(deadline));
+    EXPECT_TRUE(waiter.get());
+}
+
+TEST(PlaybackControlTest, SurfaceSignalIsNotLostBeforeWait) {
+    PlaybackControl control;
+    control.reset();
+    control.setPaused(true);
+
+    // 信号先于等待到达，等待也要立即返回
+    control.signalSurface();
+    EXPECT_TRUE(control.waitWhilePaused(control.getSerial()));
+    EXPECT_TRUE(control.takeSurfaceSignal());
+    EXPECT_FALSE(control.takeSurfaceSignal());
+}
+
+TEST(PlaybackControlTest, PrerollReadyRunsOnceWhenAllStagesDone) {
+    PlaybackControl control;
+    control.reset();
+
+    int ready = 0;
+    control.beginPreroll(2, [&] { ready++; });
+    control.prerollDone();
+    EXPECT_EQ(0, ready);
+    EXPECT_TRUE(control.isPrerolling());
+
+    control.prerollDone();
+    control.prerollDone();
+    EXPECT_EQ(1, ready);
+    EXPECT_FALSE(control.isPrerolling());
+}
+
+TEST(PlaybackControlTest, NoPrerollReadyAfterStop) {
+    PlaybackControl control;
+    control.reset();
+
+    int ready = 0;
+    control.beginPreroll(2, [&] { ready++; });
+    control.prerollDone();
+    control.stop();
+    control.prerollDone();
+    EXPECT_EQ(0, ready);
+}
+
+TEST(PlaybackControlTest, ListenersSeeStopAndRemoveIsFinal) {
+    PlaybackControl control;
+    control.reset();
+
+    std::atomic<int> calls{0};
+    std::atomic<bool> sawStopped{false};
+    int id = control.addListener([&] {
+        calls++;
+        sawStopped = control.isStopped();
+    });
+
+    control.requestSeek(2.0);
+    EXPECT_EQ(1, calls.load());
+    EXPECT_FALSE(sawStopped.load());
+
+    // listener 被调用时 token 已经取消
+    control.stop();
+    EXPECT_EQ(2, calls.load());
+    EXPECT_TRUE(sawStopped.load());
+
+    control.removeListener(id);
+    control.requestSeek(3.0);
+    control.nudge();
+    control.stop();
+    EXPECT_EQ(2, calls.load());
+}
+
+TEST(PlaybackControlTest, RemoveListenerWaitsForRunningCallback) {
+    PlaybackControl control;
+    control.reset();
+
+    std::atomic<bool> inside{false};
+    std::atomic<bool> finished{false};
+    int id = control.addListener([&] {
+        inside = true;
+        std::this_thread::sleep_for(settle);
+        finished = true;
+    });
+
+    auto notifier = std::async(std::launch::async, [&] { control.nudge(); });
+    while (!inside) std::this_thread::yield();
+
+    // removeListener 返回时回调必须已经结束，调用方可以马上释放回调引用的对象
+    control.removeListener(id);
+    EXPECT_TRUE(finished.load());
+    notifier.wait();
+}
+
+TEST(PlaybackControlTest, ResetClearsStop) {
+    PlaybackControl control;
+    control.reset();
+    control.stop();
+    control.reset();
+
+    EXPECT_FALSE(control.isStopped());
+    EXPECT_EQ(0, control.getSerial());
+    EXPECT_TRUE(control.sleepFor(0.001, control.getSerial()));
+
+    AVIOInterruptCB cb = control.cancelToken()->interruptCallback();
+    EXPECT_EQ(0, cb.callback(cb.opaque));
+    control.stop();
+    EXPECT_EQ(1, cb.callback(cb.opaque));
+}
@@ -0,0 +1,15 @@
+//
+// log.h
+// 主机测试用的 <android/log.h> 替身：丢弃日志，也不对参数求值
+//
+
+#ifndef ANDROIDPLAYER_TEST_ANDROID_LOG_H
+#define ANDROIDPLAYER_TEST_ANDROID_LOG_H
+
+#define ANDROID_LOG_DEBUG 3
+#define ANDROID_LOG_INFO 4
+#define ANDROID_LOG_ERROR 6
+
+#define __android_log_print(...) ((void) 0)
+
+#endif //ANDROIDPLAYER_TEST_ANDROID_LOG_H
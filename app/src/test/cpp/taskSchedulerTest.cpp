@@ -0,0 +1,167 @@
+//
+// taskSchedulerTest.cpp
+// 调度器的唤醒语义和工作窃取：执行中的 wake 不丢、Done 之后的 wake 被忽略、被占住的线程队列里的任务由其他线程偷走
+//
+
+#include "taskScheduler.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using namespace std::chrono_literals;
+
+// step 交给测试用 lambda 实现，记录执行次数
+class FuncTask : public Task {
+public:
+    explicit FuncTask(std::function<Status(int)> body) : body(std::move(body)) {}
+
+    Status step() override {
+        return body(++steps);
+    }
+
+    std::atomic<int> steps{0};
+
+private:
+    std::function<Status(int)> body;
+};
+
+// 测试线程和调度器线程之间的一次性信号
+class Latch {
+public:
+    void set() {
+        std::lock_guard<std::mutex> lock(mtx);
+        done = true;
+        cv.notify_all();
+    }
+
+    bool wait(std::chrono::milliseconds timeout = 5000ms) {
+        std::unique_lock<std::mutex> lock(mtx);
+        return cv.wait_for(lock, timeout, [this] { return done; });
+    }
+
+private:
+    std::mutex mtx;
+    std::condition_variable cv;
+    bool done = false;
+};
+
+}  // namespace
+
+TEST(TaskSchedulerTest, UsesAtLeastTwoWorkers) {
+    EXPECT_GE(TaskScheduler::instance().size(), 2);
+}
+
+TEST(TaskSchedulerTest, WakeWhileRunningRunsAgain) {
+    Latch running, woken;
+    auto task = std::make_shared<FuncTask>([&](int step) {
+        if (step == 1) {
+            running.set();
+            woken.wait();
+            return Task::Status::Blocked;
+        }
+        return Task::Status::Done;
+    });
+
+    task->wake();
+    ASSERT_TRUE(running.wait());
+    // 第一步还在执行：这次 wake 只能记下来，不能丢，也不能让任务同时在两个线程上跑
+    task->wake();
+    woken.set();
+
+    task->join();
+    EXPECT_EQ(2, task->steps.load());
+}
+
+TEST(TaskSchedulerTest, BlockedTaskWaitsForWake) {
+    auto task = std::make_shared<FuncTask>([](int step) {
+        return step == 1 ? Task::Status::Blocked : Task::Status::Done;
+    });
+
+    task->wake();
+    std::this_thread::sleep_for(50ms);
+    EXPECT_EQ(1, task->steps.load());
+
+    task->wake();
+    task->join();
+    EXPECT_EQ(2, task->steps.load());
+}
+
+TEST(TaskSchedulerTest, WakeAfterDoneIsIgnored) {
+    auto task = std::make_shared<FuncTask>([](int) { return Task::Status::Done; });
+
+    task->wake();
+    task->join();
+    task->wake();
+    task->wakeAfter(0.001);
+    std::this_thread::sleep_for(50ms);
+    EXPECT_EQ(1, task->steps.load());
+}
+
+TEST(TaskSchedulerTest, WakeAfterWaitsForTheDelay) {
+    auto start = std::chrono::steady_clock::now();
+    std::atomic<int64_t> elapsedMs{-1};
+    auto task = std::make_shared<FuncTask>([&](int) {
+        elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - start).count();
+        return Task::Status::Done;
+    });
+
+    task->wakeAfter(0.05);
+    task->join();
+    EXPECT_GE(elapsedMs.load(), 50);
+}
+
+TEST(TaskSchedulerTest, YieldingTasksAllComplete) {
+    const int taskCount = 64;
+    const int stepsPerTask = 50;
+    std::vector<std::shared_ptr<FuncTask>> tasks;
+    for (int i = 0; i < taskCount; i++) {
+        tasks.push_back(std::make_shared<FuncTask>([](int step) {
+            return step < stepsPerTask ? Task::Status::Yield : Task::Status::Done;
+        }));
+    }
+
+    for (auto& task : tasks) task->wake();
+    for (auto& task : tasks) task->join();
+    for (auto& task : tasks) EXPECT_EQ(stepsPerTask, task->steps.load());
+}
+
+TEST(TaskSchedulerTest, IdleWorkerStealsFromBusyWorker) {
+    const int childCount = 32;
+    std::atomic<int> finished{0};
+    Latch allFinished;
+
+    std::vector<std::shared_ptr<FuncTask>> children;
+    for (int i = 0; i < childCount; i++) {
+        children.push_back(std::make_shared<FuncTask>([&](int) {
+            if (++finished == childCount) allFinished.set();
+            return Task::Status::Done;
+        }));
+    }
+
+    // 工作线程上唤醒的任务进入它自己的队列；父任务随后占住这个线程，子任务只能被别的线程偷走
+    std::atomic<bool> stolen{false};
+    auto parent = std::make_shared<FuncTask>([&](int) {
+        for (auto& child : children) child->wake();
+        stolen = allFinished.wait();
+        return Task::Status::Done;
+    });
+
+    parent->wake();
+    parent->join();
+    EXPECT_TRUE(stolen.load());
+    for (auto& child : children) {
+        child->join();
+        EXPECT_EQ(1, child->steps.load());
+    }
+}
@@ -0,0 +1,154 @@
+//
+// yuvConverterTest.cpp
+// SIMD 内核必须和标量内核逐字节一致，包括不是向量宽度整数倍的奇数宽度和行尾之外的填充
+//
+
+#include "yuvConverter.h"
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace {
+
+// 按解码器的对齐方式留出行尾填充，内核不能读写到宽度之外的像素
+int alignedStride(int bytes) {
+    return (bytes + 63) / 64 * 64 + 64;
+}
+
+struct Image {
+    std::vector<uint8_t> planes[3];
+    AVFrame frame = {};
+};
+
+void makeSource(Image& img, AVPixelFormat format, int width, int height, std::mt19937& rng) {
+    int chromaWidth = (width + 1) / 2;
+    int chromaHeight = (height + 1) / 2;
+    bool semiPlanar = format == AV_PIX_FMT_NV12 || format == AV_PIX_FMT_NV21;
+
+    int linesize[3] = {alignedStride(width), alignedStride(semiPlanar ? chromaWidth * 2 : chromaWidth),
+                       semiPlanar ? 0 : alignedStride(chromaWidth)};
+    int rows[3] = {height, chromaHeight, semiPlanar ? 0 : chromaHeight};
+
+    std::uniform_int_distribution<int> byte(0, 255);
+    for (int i = 0; i < 3; i++) {
+        img.planes[i].resize((size_t) linesize[i] * rows[i]);
+        // 混入 0 和 255，覆盖饱和和截断
+        for (auto& b : img.planes[i]) {
+            int r = byte(rng);
+            b = (uint8_t) (r < 16 ? 0 : r > 240 ? 255 : byte(rng));
+        }
+        img.frame.data[i] = img.planes[i].empty() ? nullptr : img.planes[i].data();
+        img.frame.linesize[i] = linesize[i];
+    }
+    img.frame.width = width;
+    img.frame.height = height;
+    img.frame.format = format;
+}
+
+void makeTarget(Image& img, AVPixelFormat format, int width, int height) {
+    int bpp = format == AV_PIX_FMT_RGB565 ? 2 : 4;
+    int linesize = alignedStride(width * bpp);
+    // 固定填充值，检查内核有没有写到行尾之外
+    img.planes[0].assign((size_t) linesize * height, 0xA5);
+    img.frame.data[0] = img.planes[0].data();
+    img.frame.linesize[0] = linesize;
+    img.frame.width = width;
+    img.frame.height = height;
+    img.frame.format = format;
+}
+
+struct Case {
+    AVPixelFormat src;
+    AVColorSpace colorspace;
+    AVColorRange range;
+};
+
+const Case cases[] = {
+        {AV_PIX_FMT_YUV420P,  AVCOL_SPC_BT470BG,     AVCOL_RANGE_MPEG},
+        {AV_PIX_FMT_YUV420P,  AVCOL_SPC_BT709,       AVCOL_RANGE_JPEG},
+        {AV_PIX_FMT_YUVJ420P, AVCOL_SPC_UNSPECIFIED, AVCOL_RANGE_UNSPECIFIED},
+        {AV_PIX_FMT_NV12,     AVCOL_SPC_BT709,       AVCOL_RANGE_MPEG},
+        {AV_PIX_FMT_NV12,     AVCOL_SPC_BT470BG,     AVCOL_RANGE_JPEG},
+        {AV_PIX_FMT_NV21,     AVCOL_SPC_UNSPECIFIED, AVCOL_RANGE_MPEG},
+        {AV_PIX_FMT_NV21,     AVCOL_SPC_BT709,       AVCOL_RANGE_JPEG},
+};
+
+const AVPixelFormat targets[] = {AV_PIX_FMT_RGBA, AV_PIX_FMT_RGB565};
+
+// 覆盖 1 像素、奇数宽度、向量宽度前后各差一，以及按宽度推断色彩空间的 1280 分界
+const int widths[] = {1, 2, 3, 7, 15, 16, 17, 31, 32, 33, 47, 63, 64, 65, 127, 129, 641, 1279, 1280, 1281};
+
+}  // namespace
+
+TEST(YuvConverterTest, SimdMatchesScalar) {
+    std::mt19937 rng(20250329);
+    const int height = 5;
+
+    for (const Case& c : cases) {
+        for (AVPixelFormat dst : targets) {
+            for (int width : widths) {
+                SCOPED_TRACE(testing::Message() << "src=" << c.src << " dst=" << dst << " width=" << width
+                                                << " colorspace=" << c.colorspace << " range=" << c.range);
+                YuvConverter simd, scalar;
+                ASSERT_TRUE(simd.init(c.src, dst, c.colorspace, c.range, width));
+                ASSERT_TRUE(scalar.init(c.src, dst, c.colorspace, c.range, width, false));
+                ASSERT_STREQ(scalar.getKernelName(), "scalar");
+
+                Image source, expected, actual;
+                makeSource(source, c.src, width, height, rng);
+                makeTarget(expected, dst, width, height);
+                makeTarget(actual, dst, width, height);
+
+                scalar.convert(&source.frame, &expected.frame, 0, height);
+                // 分两段转换，和按行分片并行时一样
+                simd.convert(&source.frame, &actual.frame, 0, 2);
+                simd.convert(&source.frame, &actual.frame, 2, height);
+
+                ASSERT_EQ(expected.planes[0].size(), actual.planes[0].size());
+                ASSERT_EQ(0, memcmp(expected.planes[0].data(), actual.planes[0].data(), expected.planes[0].size()))
+                        << "kernel " << simd.getKernelName() << " differs from scalar";
+            }
+        }
+    }
+}
+
+TEST(YuvConverterTest, ScalarMatchesReferencePixel) {
+    // BT.601 limited 的白、黑和灰，标量内核本身的定点结果要落在浮点参考 ±1 以内
+    const uint8_t lumas[] = {16, 235, 128};
+    const uint8_t expected[] = {0, 255, 130};
+
+    for (int i = 0; i < 3; i++) {
+        uint8_t y = lumas[i], u = 128, v = 128;
+        AVFrame src = {};
+        src.data[0] = &y;
+        src.data[1] = &u;
+        src.data[2] = &v;
+        src.linesize[0] = src.linesize[1] = src.linesize[2] = 1;
+        src.width = 1;
+        src.height = 1;
+
+        uint8_t rgba[4] = {};
+        AVFrame dst = {};
+        dst.data[0] = rgba;
+        dst.linesize[0] = 4;
+
+        YuvConverter converter;
+        ASSERT_TRUE(converter.init(AV_PIX_FMT_YUV420P, AV_PIX_FMT_RGBA, AVCOL_SPC_BT470BG, AVCOL_RANGE_MPEG, 1,
+                                   false));
+        converter.convert(&src, &dst, 0, 1);
+        for (int ch = 0; ch < 3; ch++) {
+            EXPECT_NEAR(expected[i], rgba[ch], 1) << "luma " << (int) lumas[i] << " channel " << ch;
+        }
+        EXPECT_EQ(255, rgba[3]);
+    }
+}
+
+TEST(YuvConverterTest, RejectsUnsupportedFormats) {
+    YuvConverter converter;
+    EXPECT_FALSE(converter.init(AV_PIX_FMT_YUV422P, AV_PIX_FMT_RGBA, AVCOL_SPC_BT709, AVCOL_RANGE_MPEG, 64));
+    EXPECT_FALSE(converter.init(AV_PIX_FMT_YUV420P10LE, AV_PIX_FMT_RGBA, AVCOL_SPC_BT709, AVCOL_RANGE_MPEG, 64));
+    EXPECT_FALSE(converter.init(AV_PIX_FMT_NV12, AV_PIX_FMT_BGR24, AVCOL_SPC_BT709, AVCOL_RANGE_MPEG, 64));
+}